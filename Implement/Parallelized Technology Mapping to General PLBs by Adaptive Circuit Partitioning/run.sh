@@ -16,20 +16,20 @@ yosys -p "
     write_json data/input.json
 "
 
-# 生成超图，转换为 KaHyPar 的输入文件
-xmake run verilog2kahypar ../data/input.json
+# 生成超图并直接在进程内划分（多级 km1 划分器），写出与 KaHyPar 同名的 .names 和划分结果；
+# 顶层网表另存为二进制快照，后面不必再解析 JSON
+xmake run verilog2kahypar ../data/input.json --snapshot=../data/input.snapshot --partition=3 --epsilon=0.03 --seed=-1
 
-# 运行 KaHyPar 进行划分
-KaHyPar -h kahypar/run_hmetis.txt -k 3 -e 0.03 -o km1 -m direct -p kahypar/km1_kKaHyPar_sea20.ini -w true
+# 也可以去掉 --partition 只生成 hMetis 文件，再用 KaHyPar 划分
+# KaHyPar -h kahypar/run_hmetis.txt -k 3 -e 0.03 -o km1 -m direct -p kahypar/km1_kKaHyPar_sea20.ini -w true
 
-# 生成划分子集对应的 Verilog 文件
+# 生成划分子集对应的网表；yosys JSON 保留 cell 参数，综合时不必再跑 Verilog 前端
 cd partitioned_verilog
-rm -rf *.v
+rm -rf *.v *.json
 cd ..
-xmake run partition2verilog ../data/input.json ../kahypar/run_hmetis.txt.names ../kahypar/run_hmetis.txt.part3.epsilon0.03.seed-1.KaHyPar ../partitioned_verilog
 
+# --ready 每写完一个分区就输出它的路径，该分区的综合随即开始，其余分区同时继续生成
 JOBS=$(sysctl -n hw.ncpu 2>/dev/null || echo 4)
-cd partitioned_verilog
-ls *.v | sed 's/\.v$//' | xargs -I{} -P "$JOBS" sh -c 'yosys -q -p "read_verilog {}.v; hierarchy -top {}; synth; write_verilog {}_synth.v"'
-cd ..
+xmake run partition2verilog --format=json --ready ../data/input.snapshot ../kahypar/run_hmetis.txt.names ../kahypar/run_hmetis.txt.part3.epsilon0.03.seed-1.KaHyPar ../partitioned_verilog \
+    | xargs -I{} -P "$JOBS" sh -c 'm=$(basename {} .json); cd partitioned_verilog && yosys -q -p "read_json $m.json; hierarchy -top $m; synth; write_verilog ${m}_synth.v"'
 
@@ -8,6 +8,8 @@
 #include <iomanip>
 #include <sstream>
 #include <ctime>
+#include <utility>
+#include <vector>
 
 namespace global {
 
@@ -66,7 +68,27 @@ inline bool level_enabled(LogLevel msg, LogLevel thr) {
     return static_cast<int>(msg) >= static_cast<int>(thr);
 }
 
+// While a LogBuffer is installed on a thread, what that thread logs is kept in the buffer
+// instead of being written. Work running in parallel can then be logged in a fixed order.
+using LogBuffer = std::vector<std::pair<LogLevel, std::string>>;
+
+inline LogBuffer*& thread_log_buffer() { thread_local LogBuffer* b = nullptr; return b; }
+
+class ScopedLogBuffer {
+public:
+    explicit ScopedLogBuffer(LogBuffer& buf) : _prev(thread_log_buffer()) { thread_log_buffer() = &buf; }
+    ~ScopedLogBuffer() { thread_log_buffer() = _prev; }
+    ScopedLogBuffer(const ScopedLogBuffer&) = delete;
+    ScopedLogBuffer& operator=(const ScopedLogBuffer&) = delete;
+private:
+    LogBuffer* _prev;
+};
+
 inline void log(LogLevel lv, const std::string& msg) {
+    if (auto* buf = thread_log_buffer()) {
+        buf->emplace_back(lv, msg);
+        return;
+    }
     std::lock_guard<std::mutex> lk(log_mutex());
     auto& s = logger_state();
     if (!s.initialized) return;
@@ -81,6 +103,10 @@ inline void log_warning(const std::string& msg) { log(LogLevel::WARNING, msg); }
 inline void log_exception(const std::string& msg) { log(LogLevel::EXCEPTION, msg); }
 inline void log_fatal(const std::string& msg) { log(LogLevel::FATAL, msg); }
 
+inline void flush_log(const LogBuffer& buf) {
+    for (const auto& [lv, msg] : buf) log(lv, msg);
+}
+
 }
 
 #endif
@@ -0,0 +1,223 @@
+#ifndef HGRAPH_FILE_HH
+#define HGRAPH_FILE_HH
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "mapped_file.hh"
+
+namespace global {
+
+// Output file with a large buffer of its own; integers are formatted with std::to_chars
+// straight into it, so writing text costs about as much as copying it.
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& path, bool binary = false, std::size_t capacity = std::size_t{1} << 20)
+        : _path(path), _file(std::fopen(path.c_str(), binary ? "wb" : "w")), _buf(new char[capacity]), _cap(capacity)
+    {
+        if (!_file) throw std::runtime_error("cannot open file for writing: " + path);
+    }
+
+    ~BufferedWriter() {
+        if (!_file) return;
+        try { close(); } catch (...) {}     // close() explicitly to see write errors
+    }
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void put(char c) {
+        if (_len == _cap) drain();
+        _buf[_len++] = c;
+    }
+
+    void put(std::string_view s) {
+        if (s.size() > _cap - _len) {
+            drain();
+            if (s.size() > _cap) { raw(s.data(), s.size()); return; }
+        }
+        std::memcpy(_buf.get() + _len, s.data(), s.size());
+        _len += s.size();
+    }
+
+    template <typename Int>
+    void put_int(Int v) {
+        if (_cap - _len < 24) drain();           // any 64-bit integer fits
+        const auto r = std::to_chars(_buf.get() + _len, _buf.get() + _cap, v);
+        _len = static_cast<std::size_t>(r.ptr - _buf.get());
+    }
+
+    void put_bytes(const void* p, std::size_t n) { put(std::string_view(static_cast<const char*>(p), n)); }
+
+    void close() {
+        drain();
+        const bool ok = std::fclose(_file) == 0;
+        _file = nullptr;
+        if (!ok) throw std::runtime_error("cannot write file: " + _path);
+    }
+
+private:
+    void drain() {
+        raw(_buf.get(), _len);
+        _len = 0;
+    }
+
+    void raw(const char* p, std::size_t n) {
+        if (n && std::fwrite(p, 1, n, _file) != n) throw std::runtime_error("cannot write file: " + _path);
+    }
+
+    std::string _path;
+    std::FILE* _file;
+    std::unique_ptr<char[]> _buf;       // not zero-filled: only the written prefix is touched
+    std::size_t _cap;
+    std::size_t _len = 0;
+};
+
+// hMetis text from a CSR hypergraph: pins of edge e are pins[offsets[e] .. offsets[e + 1]),
+// vertex ids 0-based (written 1-based). mode is the hMetis fmt field: 1 edge weights,
+// 10 vertex weights, 11 both.
+template <typename Offset, typename Pin, typename Weight>
+void write_hmetis(const std::string& path, std::size_t mode, std::size_t num_vertices,
+    std::span<const Offset> offsets, std::span<const Pin> pins,
+    std::span<const Weight> edge_weights, std::span<const Weight> vertex_weights)
+{
+    const auto num_edges = offsets.size() - 1;
+    BufferedWriter out(path);
+    out.put_int(num_edges); out.put(' '); out.put_int(num_vertices); out.put(' '); out.put_int(mode); out.put('\n');
+
+    const bool edge_w = (mode == 1 || mode == 11);
+    for (std::size_t e = 0; e < num_edges; ++e) {
+        if (edge_w) { out.put_int(edge_weights[e]); out.put(' '); }
+        for (auto p = offsets[e]; p < offsets[e + 1]; ++p) {
+            if (p != offsets[e]) out.put(' ');
+            out.put_int(static_cast<std::uint64_t>(pins[p]) + 1);
+        }
+        out.put('\n');
+    }
+
+    if (mode == 10 || mode == 11) {
+        for (std::size_t v = 0; v < num_vertices; ++v) {
+            out.put_int(vertex_weights[v]);
+            out.put('\n');
+        }
+    }
+    out.close();
+}
+
+// Binary CSR hypergraph, the same content as an hMetis file with both weights, but
+// loadable by mapping it. Host byte order; sections 8-byte aligned, in this order:
+//   HgraphHeader, u64 offsets[num_edges + 1], u32 pins[num_pins] (0-based),
+//   i64 edge_weights[num_edges], i64 vertex_weights[num_vertices]
+inline constexpr char HGRAPH_MAGIC[8] = {'H', 'G', 'R', 'C', 'S', 'R', '\0', '\0'};
+inline constexpr std::uint32_t HGRAPH_VERSION = 1;
+
+struct HgraphHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t num_vertices, num_edges, num_pins;
+};
+
+template <typename Offset, typename Pin, typename Weight>
+void write_hgraph_binary(const std::string& path, std::size_t num_vertices,
+    std::span<const Offset> offsets, std::span<const Pin> pins,
+    std::span<const Weight> edge_weights, std::span<const Weight> vertex_weights)
+{
+    HgraphHeader h{};
+    std::memcpy(h.magic, HGRAPH_MAGIC, sizeof h.magic);
+    h.version = HGRAPH_VERSION;
+    h.num_vertices = num_vertices;
+    h.num_edges = offsets.size() - 1;
+    h.num_pins = pins.size();
+    if (num_vertices > UINT32_MAX) throw std::runtime_error("too many vertices for a binary hypergraph: " + path);
+
+    BufferedWriter out(path, true);
+    std::uint64_t at = 0;
+    // arrays already in the file's type go out in one piece, others converted in blocks
+    const auto put = [&]<typename To, typename From>(std::span<const From> items) {
+        if constexpr (sizeof(From) == sizeof(To) && std::is_signed_v<From> == std::is_signed_v<To>) {
+            out.put_bytes(items.data(), items.size_bytes());
+        } else {
+            To block[4096];
+            for (std::size_t i = 0; i < items.size(); i += std::size(block)) {
+                const auto n = std::min(std::size(block), items.size() - i);
+                for (std::size_t k = 0; k < n; ++k) block[k] = static_cast<To>(items[i + k]);
+                out.put_bytes(block, n * sizeof(To));
+            }
+        }
+        at += items.size() * sizeof(To);
+    };
+    out.put_bytes(&h, sizeof h);
+    at += sizeof h;
+    put.template operator()<std::uint64_t>(offsets);
+    put.template operator()<std::uint32_t>(pins);
+    static constexpr char zero[8] = {};
+    out.put_bytes(zero, (8 - at % 8) % 8);
+    put.template operator()<std::int64_t>(edge_weights);
+    put.template operator()<std::int64_t>(vertex_weights);
+    out.close();
+}
+
+// Mapped binary hypergraph; the spans point into the file and are checked once on load.
+class HgraphBinary {
+public:
+    explicit HgraphBinary(const std::string& path) : _file(path) {
+        if (_file.size() < sizeof(HgraphHeader) || std::memcmp(_file.data(), HGRAPH_MAGIC, sizeof HGRAPH_MAGIC) != 0) {
+            throw std::runtime_error("not a binary hypergraph: " + path);
+        }
+        std::memcpy(&_h, _file.data(), sizeof _h);
+        if (_h.version != HGRAPH_VERSION) {
+            throw std::runtime_error("binary hypergraph " + path + " has version " + std::to_string(_h.version)
+                + ", expected " + std::to_string(HGRAPH_VERSION));
+        }
+        std::uint64_t at = sizeof _h;
+        _offsets = section<std::uint64_t>(at, _h.num_edges + 1, path);
+        _pins = section<std::uint32_t>(at, _h.num_pins, path);
+        at = (at + 7) & ~std::uint64_t{7};
+        _edge_weights = section<std::int64_t>(at, _h.num_edges, path);
+        _vertex_weights = section<std::int64_t>(at, _h.num_vertices, path);
+
+        bool ok = _offsets.front() == 0 && _offsets.back() == _h.num_pins;
+        for (std::size_t e = 0; ok && e < _h.num_edges; ++e) ok = _offsets[e] <= _offsets[e + 1];
+        for (std::size_t p = 0; ok && p < _pins.size(); ++p) ok = _pins[p] < _h.num_vertices;
+        if (!ok) throw std::runtime_error("binary hypergraph " + path + " is corrupt");
+    }
+
+    std::size_t num_vertices() const { return _h.num_vertices; }
+    std::size_t num_edges() const { return _h.num_edges; }
+    std::span<const std::uint64_t> offsets() const { return _offsets; }
+    std::span<const std::uint32_t> pins() const { return _pins; }
+    std::span<const std::int64_t> edge_weights() const { return _edge_weights; }
+    std::span<const std::int64_t> vertex_weights() const { return _vertex_weights; }
+
+private:
+    template <typename T>
+    std::span<const T> section(std::uint64_t& at, std::uint64_t count, const std::string& path) const {
+        if (at > _file.size() || count > (_file.size() - at) / sizeof(T)) {
+            throw std::runtime_error("binary hypergraph " + path + " is truncated");
+        }
+        const std::span<const T> s(reinterpret_cast<const T*>(_file.data() + at), count);
+        at += count * sizeof(T);
+        return s;
+    }
+
+    MappedFile _file;
+    HgraphHeader _h{};
+    std::span<const std::uint64_t> _offsets;
+    std::span<const std::uint32_t> _pins;
+    std::span<const std::int64_t> _edge_weights;
+    std::span<const std::int64_t> _vertex_weights;
+};
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef MAPPED_FILE_HH
+#define MAPPED_FILE_HH
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace global {
+
+// Read-only view of a whole input file. On POSIX the file is mmap'ed, so parsers
+// read straight from the page cache and nothing is copied to the heap; string_views
+// taken from view() stay valid for the lifetime of the MappedFile.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary);
+        if (!in.good()) throw std::runtime_error("cannot open file: " + path);
+        _buf.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        _data = _buf.data();
+        _size = _buf.size();
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open file: " + path + ": " + std::strerror(errno));
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::runtime_error("cannot stat file: " + path + ": " + std::strerror(err));
+        }
+        _size = static_cast<std::size_t>(st.st_size);
+        if (_size > 0) {
+            void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                const int err = errno;
+                ::close(fd);
+                throw std::runtime_error("cannot map file: " + path + ": " + std::strerror(err));
+            }
+            ::madvise(p, _size, MADV_SEQUENTIAL);
+            _data = static_cast<const char*>(p);
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() { release(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { take(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) { release(); take(other); }
+        return *this;
+    }
+
+    const char* data() const { return _data ? _data : ""; }
+    std::size_t size() const { return _size; }
+    std::string_view view() const { return std::string_view(data(), _size); }
+
+private:
+    void release() {
+#if !defined(_WIN32)
+        if (_data) ::munmap(const_cast<char*>(_data), _size);
+#endif
+        _data = nullptr;
+        _size = 0;
+    }
+
+    void take(MappedFile& other) {
+#if defined(_WIN32)
+        _buf = std::move(other._buf);
+        _data = _buf.data();
+#else
+        _data = other._data;
+#endif
+        _size = other._size;
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+#if defined(_WIN32)
+    std::string _buf;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+#ifndef NETLIST_SNAPSHOT_HH
+#define NETLIST_SNAPSHOT_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "mapped_file.hh"
+
+namespace global {
+
+// Binary snapshot of the top module of a yosys JSON netlist. verilog2kahypar writes it
+// once after parsing, partition2verilog maps it instead of parsing the JSON a second time.
+// It is a cache between the two tools of one flow, not an exchange format: integers are
+// stored in host byte order and a version mismatch is simply an error.
+//
+// Layout, every section 8-byte aligned, offsets in the header:
+//   strings   u32 offsets[n_strings + 1] and the character blob; every name is stored once
+//   ports     SnapshotPort[n_ports]      module ports, sorted by name
+//   cells     SnapshotCell[n_cells]      sorted by name
+//   pins      SnapshotPort[n_pins]       pins of cell c are [first_pin, first_pin + pin_count)
+//   params    SnapshotParam[n_params]    parameters of cell c are [first_param, first_param + param_count),
+//                                        values as their JSON text, as yosys wrote them
+//   bits      u32[n_bits]                signal ids; the constants 0/1/x/z are the top four
+//                                        values, as in the reader's packed bits
+
+inline constexpr char SNAPSHOT_MAGIC[8] = {'N', 'L', 'S', 'N', 'A', 'P', '\0', '\0'};
+inline constexpr std::uint32_t SNAPSHOT_VERSION = 2;
+inline constexpr std::uint32_t SNAPSHOT_CONST_0 = 0xFFFFFFFCu;   // then '1', 'x', 'z'
+
+enum class SnapshotDirection : std::uint32_t { INPUT, OUTPUT, INOUT };
+
+struct SnapshotPort {
+    std::uint32_t name;
+    SnapshotDirection direction;
+    std::uint32_t first_bit;
+    std::uint32_t bit_count;
+};
+
+struct SnapshotParam {
+    std::uint32_t name;
+    std::uint32_t value;
+};
+
+struct SnapshotCell {
+    std::uint32_t name;
+    std::uint32_t type;
+    std::uint32_t first_pin;
+    std::uint32_t pin_count;
+    std::uint32_t first_param;
+    std::uint32_t param_count;
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t top_name;
+    std::uint64_t source_hash;          // of the JSON the snapshot was built from
+    std::uint64_t source_size;
+    std::uint32_t n_strings, n_ports, n_cells, n_pins, n_params, n_bits, n_blob, reserved;
+    std::uint64_t off_strings, off_blob, off_ports, off_cells, off_pins, off_params, off_bits;
+};
+
+// 64-bit FNV-1a, the content hash of a snapshot's source
+inline std::uint64_t content_hash(std::string_view data) {
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (unsigned char c : data) h = (h ^ c) * 0x100000001B3ull;
+    return h;
+}
+
+inline const char* direction_name(SnapshotDirection d) {
+    switch (d) {
+        case SnapshotDirection::INPUT: return "input";
+        case SnapshotDirection::OUTPUT: return "output";
+        default: return "inout";
+    }
+}
+
+// Collects the tables in memory and writes them out in one go.
+class NetlistSnapshotBuilder {
+public:
+    std::uint32_t intern(std::string_view s) {
+        const auto it = _ids.find(std::string(s));
+        if (it != _ids.end()) return it->second;
+        const auto id = static_cast<std::uint32_t>(_offsets.size() - 1);
+        _blob.append(s);
+        _offsets.emplace_back(static_cast<std::uint32_t>(_blob.size()));
+        _ids.emplace(std::string(s), id);
+        return id;
+    }
+
+    void set_top(std::string_view name) { _top = intern(name); }
+
+    template <typename Bits>
+    void add_port(std::string_view name, SnapshotDirection dir, const Bits& bits) {
+        _ports.push_back(make_port(name, dir, bits));
+    }
+
+    // pins and parameters follow with add_pin and add_param, in the order they should be stored
+    void add_cell(std::string_view name, std::string_view type) {
+        _cells.push_back(SnapshotCell{intern(name), intern(type), static_cast<std::uint32_t>(_pins.size()), 0,
+            static_cast<std::uint32_t>(_params.size()), 0});
+    }
+
+    template <typename Bits>
+    void add_pin(std::string_view name, SnapshotDirection dir, const Bits& bits) {
+        if (_cells.empty()) throw std::logic_error("snapshot pin added before any cell");
+        _pins.push_back(make_port(name, dir, bits));
+        ++_cells.back().pin_count;
+    }
+
+    // value is the JSON text of the parameter value
+    void add_param(std::string_view name, std::string_view value) {
+        if (_cells.empty()) throw std::logic_error("snapshot parameter added before any cell");
+        _params.push_back(SnapshotParam{intern(name), intern(value)});
+        ++_cells.back().param_count;
+    }
+
+    void write(const std::string& path, std::uint64_t source_hash, std::uint64_t source_size) const {
+        SnapshotHeader h{};
+        std::memcpy(h.magic, SNAPSHOT_MAGIC, sizeof h.magic);
+        h.version = SNAPSHOT_VERSION;
+        h.top_name = _top;
+        h.source_hash = source_hash;
+        h.source_size = source_size;
+        h.n_strings = static_cast<std::uint32_t>(_offsets.size() - 1);
+        h.n_ports = static_cast<std::uint32_t>(_ports.size());
+        h.n_cells = static_cast<std::uint32_t>(_cells.size());
+        h.n_pins = static_cast<std::uint32_t>(_pins.size());
+        h.n_params = static_cast<std::uint32_t>(_params.size());
+        h.n_bits = static_cast<std::uint32_t>(_bits.size());
+        h.n_blob = static_cast<std::uint32_t>(_blob.size());
+
+        std::uint64_t end = sizeof h;
+        const auto place = [&](std::uint64_t bytes) { const auto at = align(end); end = at + bytes; return at; };
+        h.off_strings = place(_offsets.size() * sizeof(std::uint32_t));
+        h.off_blob = place(_blob.size());
+        h.off_ports = place(_ports.size() * sizeof(SnapshotPort));
+        h.off_cells = place(_cells.size() * sizeof(SnapshotCell));
+        h.off_pins = place(_pins.size() * sizeof(SnapshotPort));
+        h.off_params = place(_params.size() * sizeof(SnapshotParam));
+        h.off_bits = place(_bits.size() * sizeof(std::uint32_t));
+
+        std::string out(end, '\0');
+        const auto put = [&](std::uint64_t at, const void* p, std::size_t bytes) { if (bytes) std::memcpy(out.data() + at, p, bytes); };
+        put(0, &h, sizeof h);
+        put(h.off_strings, _offsets.data(), _offsets.size() * sizeof(std::uint32_t));
+        put(h.off_blob, _blob.data(), _blob.size());
+        put(h.off_ports, _ports.data(), _ports.size() * sizeof(SnapshotPort));
+        put(h.off_cells, _cells.data(), _cells.size() * sizeof(SnapshotCell));
+        put(h.off_pins, _pins.data(), _pins.size() * sizeof(SnapshotPort));
+        put(h.off_params, _params.data(), _params.size() * sizeof(SnapshotParam));
+        put(h.off_bits, _bits.data(), _bits.size() * sizeof(std::uint32_t));
+
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f.good()) throw std::runtime_error("cannot write netlist snapshot: " + path);
+        f.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!f.good()) throw std::runtime_error("cannot write netlist snapshot: " + path);
+    }
+
+private:
+    static std::uint64_t align(std::uint64_t at) { return (at + 7) & ~std::uint64_t{7}; }
+
+    template <typename Bits>
+    SnapshotPort make_port(std::string_view name, SnapshotDirection dir, const Bits& bits) {
+        SnapshotPort p{intern(name), dir, static_cast<std::uint32_t>(_bits.size()), 0};
+        for (auto b : bits) _bits.emplace_back(static_cast<std::uint32_t>(b));
+        p.bit_count = static_cast<std::uint32_t>(_bits.size() - p.first_bit);
+        return p;
+    }
+
+    std::unordered_map<std::string, std::uint32_t> _ids;
+    std::vector<std::uint32_t> _offsets{0};
+    std::string _blob;
+    std::uint32_t _top{0};
+    std::vector<SnapshotPort> _ports;
+    std::vector<SnapshotCell> _cells;
+    std::vector<SnapshotPort> _pins;
+    std::vector<SnapshotParam> _params;
+    std::vector<std::uint32_t> _bits;
+};
+
+// Read-only view of a snapshot file; the tables point straight into the mapped pages.
+class NetlistSnapshot {
+public:
+    explicit NetlistSnapshot(const std::string& path) : _file(path) {
+        if (!is_snapshot(_file.view())) throw std::runtime_error("not a netlist snapshot: " + path);
+        std::memcpy(&_h, _file.data(), sizeof _h);
+        if (_h.version != SNAPSHOT_VERSION) {
+            throw std::runtime_error("netlist snapshot " + path + " has version " + std::to_string(_h.version)
+                + ", expected " + std::to_string(SNAPSHOT_VERSION));
+        }
+        _offsets = section<std::uint32_t>(_h.off_strings, std::size_t{_h.n_strings} + 1, path);
+        _blob = std::string_view(section<char>(_h.off_blob, _h.n_blob, path).data(), _h.n_blob);
+        _ports = section<SnapshotPort>(_h.off_ports, _h.n_ports, path);
+        _cells = section<SnapshotCell>(_h.off_cells, _h.n_cells, path);
+        _pins = section<SnapshotPort>(_h.off_pins, _h.n_pins, path);
+        _params = section<SnapshotParam>(_h.off_params, _h.n_params, path);
+        _bits = section<std::uint32_t>(_h.off_bits, _h.n_bits, path);
+        // every id and range is checked once here, so the accessors below need not
+        bool ok = _offsets.front() == 0 && _offsets.back() <= _blob.size() && _h.top_name < _h.n_strings;
+        for (std::size_t i = 1; ok && i < _offsets.size(); ++i) ok = _offsets[i - 1] <= _offsets[i];
+        const auto port_ok = [&](const SnapshotPort& p) {
+            return p.name < _h.n_strings && p.first_bit <= _h.n_bits && p.bit_count <= _h.n_bits - p.first_bit;
+        };
+        for (const auto& p : _ports) ok = ok && port_ok(p);
+        for (const auto& p : _pins) ok = ok && port_ok(p);
+        for (const auto& p : _params) ok = ok && p.name < _h.n_strings && p.value < _h.n_strings;
+        for (const auto& c : _cells) {
+            ok = ok && c.name < _h.n_strings && c.type < _h.n_strings && c.first_pin <= _h.n_pins && c.pin_count <= _h.n_pins - c.first_pin
+                && c.first_param <= _h.n_params && c.param_count <= _h.n_params - c.first_param;
+        }
+        if (!ok) throw std::runtime_error("netlist snapshot " + path + " is corrupt");
+    }
+
+    static bool is_snapshot(std::string_view data) {
+        return data.size() >= sizeof(SnapshotHeader) && std::memcmp(data.data(), SNAPSHOT_MAGIC, sizeof SNAPSHOT_MAGIC) == 0;
+    }
+
+    // the snapshot at `path` was built from `source` (same size and content hash)
+    static bool matches(const std::string& path, std::string_view source) {
+        try {
+            NetlistSnapshot s(path);
+            return s.source_size() == source.size() && s.source_hash() == content_hash(source);
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    std::uint64_t source_hash() const { return _h.source_hash; }
+    std::uint64_t source_size() const { return _h.source_size; }
+    std::string_view top_name() const { return str(_h.top_name); }
+    std::string_view str(std::uint32_t id) const { return _blob.substr(_offsets[id], _offsets[id + 1] - _offsets[id]); }
+
+    std::span<const SnapshotPort> ports() const { return _ports; }
+    std::span<const SnapshotCell> cells() const { return _cells; }
+    std::span<const SnapshotPort> pins(const SnapshotCell& c) const { return _pins.subspan(c.first_pin, c.pin_count); }
+    std::span<const SnapshotParam> params(const SnapshotCell& c) const { return _params.subspan(c.first_param, c.param_count); }
+    std::span<const std::uint32_t> bits(const SnapshotPort& p) const { return _bits.subspan(p.first_bit, p.bit_count); }
+
+private:
+    template <typename T>
+    std::span<const T> section(std::uint64_t offset, std::size_t count, const std::string& path) const {
+        if (offset % alignof(T) != 0 || offset > _file.size() || count > (_file.size() - offset) / sizeof(T)) {
+            throw std::runtime_error("netlist snapshot " + path + " is truncated");
+        }
+        return std::span<const T>(reinterpret_cast<const T*>(_file.data() + offset), count);
+    }
+
+    MappedFile _file;
+    SnapshotHeader _h{};
+    std::span<const std::uint32_t> _offsets;
+    std::string_view _blob;
+    std::span<const SnapshotPort> _ports;
+    std::span<const SnapshotCell> _cells;
+    std::span<const SnapshotPort> _pins;
+    std::span<const SnapshotParam> _params;
+    std::span<const std::uint32_t> _bits;
+};
+
+}
+
+#endif
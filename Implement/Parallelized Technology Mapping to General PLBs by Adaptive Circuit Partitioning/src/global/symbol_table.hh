@@ -0,0 +1,82 @@
+#ifndef SYMBOL_TABLE_HH
+#define SYMBOL_TABLE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace global {
+
+// A name interned in a SymbolTable. Two symbols of the same table are equal exactly when
+// their names are, so names can be compared, hashed and used as keys as plain integers.
+using Symbol = std::uint32_t;
+
+inline constexpr Symbol NO_SYMBOL = 0xFFFFFFFFu;
+
+// Interns names into 32-bit symbols. Every distinct name is copied once into large
+// character blocks; the views handed out by str() stay valid for the lifetime of the
+// table, also when it is moved. Not thread-safe: a table belongs to one builder thread.
+class SymbolTable {
+public:
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    SymbolTable(SymbolTable&&) noexcept = default;
+    SymbolTable& operator=(SymbolTable&&) noexcept = default;
+
+    Symbol intern(std::string_view name) {
+        const auto it = _ids.find(name);
+        if (it != _ids.end()) return it->second;
+        if (_names.size() >= NO_SYMBOL) throw std::length_error("symbol table is full");
+        const auto stored = store(name);
+        const auto id = static_cast<Symbol>(_names.size());
+        _names.push_back(stored);
+        _ids.emplace(stored, id);
+        return id;
+    }
+
+    // NO_SYMBOL if the name was never interned
+    Symbol find(std::string_view name) const {
+        const auto it = _ids.find(name);
+        return it == _ids.end() ? NO_SYMBOL : it->second;
+    }
+
+    std::string_view str(Symbol s) const { return _names[s]; }
+    std::string string(Symbol s) const { return std::string(_names[s]); }
+    std::size_t size() const { return _names.size(); }
+
+private:
+    static constexpr std::size_t BLOCK = std::size_t{1} << 16;
+
+    std::string_view store(std::string_view name) {
+        if (name.size() > BLOCK / 4) {          // long names get an allocation of their own
+            _large.emplace_back(new char[name.size()]);
+            std::memcpy(_large.back().get(), name.data(), name.size());
+            return std::string_view(_large.back().get(), name.size());
+        }
+        if (_blocks.empty() || BLOCK - _used < name.size()) {
+            _blocks.emplace_back(new char[BLOCK]);
+            _used = 0;
+        }
+        char* at = _blocks.back().get() + _used;
+        std::memcpy(at, name.data(), name.size());
+        _used += name.size();
+        return std::string_view(at, name.size());
+    }
+
+    std::vector<std::unique_ptr<char[]>> _blocks;   // the last one is being filled
+    std::vector<std::unique_ptr<char[]>> _large;
+    std::size_t _used = 0;                          // bytes used in the last block
+    std::vector<std::string_view> _names;           // index is the symbol
+    std::unordered_map<std::string_view, Symbol> _ids;
+};
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef THREAD_POOL_HH
+#define THREAD_POOL_HH
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace global {
+
+// number of workers to use when the caller asks for 0 ("as many as the machine has")
+inline std::size_t default_threads() {
+    const auto n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<std::size_t>(n);
+}
+
+// Fixed-size pool of worker threads fed from one FIFO queue. With a single thread no
+// worker is started and tasks run inline on the caller, so serial runs behave exactly
+// as they did before the pool existed.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threads = 0) {
+        if (threads == 0) threads = default_threads();
+        if (threads == 1) return;
+        _workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto& w : _workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return _workers.empty() ? 1 : _workers.size(); }
+
+    template <typename F>
+    auto submit(F&& f) -> std::future<decltype(f())> {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto result = task->get_future();
+        if (_workers.empty()) {
+            (*task)();
+            return result;
+        }
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _queue.emplace_back([task] { (*task)(); });
+        }
+        _cv.notify_one();
+        return result;
+    }
+
+    // f(i) for every i in [0, n); returns once all calls finished. If any call throws,
+    // the exception of the lowest index is rethrown.
+    template <typename F>
+    void parallel_for(std::size_t n, F&& f) {
+        std::vector<std::future<void>> done;
+        done.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            done.emplace_back(submit([&f, i] { f(i); }));
+        }
+        std::exception_ptr first;
+        for (auto& d : done) {
+            try {
+                d.get();
+            } catch (...) {
+                if (!first) first = std::current_exception();
+            }
+        }
+        if (first) std::rethrow_exception(first);
+    }
+
+private:
+    void work() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lk(_mutex);
+                _cv.wait(lk, [this] { return _stop || !_queue.empty(); });
+                if (_queue.empty()) return;
+                job = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _queue;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _stop = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,32 @@
+#include <exception>
+#include <iostream>
+#include <string>
+#include "../global/hgraph_file.hh"
+
+// 把 verilog2kahypar --binary 输出的二进制 CSR 超图转换成 hMetis 文本
+int main(int argc, char** argv) {
+  const auto usage = [] {
+    std::cerr << "usage: hgraph2hmetis <binary_hgraph> <hmetis_out> [mode: 0 | 1 | 10 | 11, default 11]\n";
+    return 1;
+  };
+  if (argc < 3) {
+    return usage();
+  }
+  std::size_t mode = 11;
+  if (argc > 3) {
+    const std::string arg = argv[3];
+    if (arg != "0" && arg != "1" && arg != "10" && arg != "11") {
+      return usage();
+    }
+    mode = std::stoul(arg);
+  }
+  try {
+    const global::HgraphBinary hg(argv[1]);
+    global::write_hmetis(argv[2], mode, hg.num_vertices(), hg.offsets(), hg.pins(), hg.edge_weights(), hg.vertex_weights());
+    std::cout << argv[2] << ": " << hg.num_edges() << " edges, " << hg.num_vertices() << " vertices\n";
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 2;
+  }
+}
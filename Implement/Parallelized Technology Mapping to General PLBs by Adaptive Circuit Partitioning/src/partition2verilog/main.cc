@@ -1,22 +1,38 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include "writer.hh"
 #include "../global/debug.hh"
 
 int main(int argc, char** argv) {
-  if (argc < 5) {
-    std::cerr << "usage: partition2verilog <yosys_json> <vertices_txt> <part_file> <out_dir>\n";
+  // options may stand anywhere, the rest are positional
+  std::vector<std::string> args;
+  OutputFormat format = OutputFormat::VERILOG;
+  bool ready = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--format=verilog") format = OutputFormat::VERILOG;
+    else if (a == "--format=json") format = OutputFormat::JSON;
+    else if (a == "--ready") ready = true;         // 每写完一个文件就把路径打印到 stdout
+    else if (a.rfind("--", 0) == 0) { std::cerr << "unknown option: " << a << "\n"; return 1; }
+    else args.push_back(a);
+  }
+  if (args.size() < 4) {
+    std::cerr << "usage: partition2verilog [--format=verilog|json] [--ready] <yosys_json | netlist_snapshot> <vertices_txt> <part_file> <out_dir> [threads]\n";
     return 1;
   }
-  std::string json_path = argv[1];
-  std::string vertices_txt = argv[2];
-  std::string part_file = argv[3];
-  std::string out_dir = argv[4];
+  std::string json_path = args[0];
+  std::string vertices_txt = args[1];
+  std::string part_file = args[2];
+  std::string out_dir = args[3];
   global::init_log("debug_write.log", false);
   global::set_log_level(global::LogLevel::DEBUG);
   global::log_info("partition2verilog start");
   Writer w;
+  w.set_format(format);
+  if (ready) w.set_ready(&std::cout);
   try {
+    if (args.size() > 4) w.set_threads(std::stoul(args[4]));   // 缺省或 0：每个核一个线程
     int rc = w.run(json_path, vertices_txt, part_file, out_dir);
     global::log_info("partition2verilog done");
     return rc;
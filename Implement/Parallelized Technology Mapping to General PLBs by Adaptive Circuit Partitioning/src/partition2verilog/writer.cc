@@ -1,35 +1,145 @@
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <exception>
 #include <fstream>
+#include <ostream>
 #include <memory>
-#include <sstream>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "../json/json.h"
 #include "writer.hh"
 #include "../global/debug.hh"
+#include "../global/mapped_file.hh"
+#include "../global/netlist_snapshot.hh"
+#include "../global/thread_pool.hh"
 
+ModuleInfo::ModuleInfo()
+  : top(symbols.intern("$top")), input(symbols.intern("input")), output(symbols.intern("output")) {}
+
+// comma-joined bit ids, the name of a net in the log
 std::string Writer::normalize_bits(const std::vector<int>& bits) {
-  std::ostringstream os;
+  std::string out;
+  char buf[16];
   for (size_t i = 0; i < bits.size(); ++i) {
-    if (i) os << ',';
-    os << bits[i];
+    if (i) out.push_back(',');
+    out.append(buf, std::to_chars(buf, buf + sizeof buf, bits[i]).ptr);
+  }
+  return out;
+}
+
+namespace {
+
+// FNV-1a over the bit ids; nets are identified by their whole bit vector
+struct BitsHash {
+  size_t operator()(const std::vector<int>& bits) const noexcept {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (int b : bits) h = (h ^ (uint32_t)b) * 0x100000001B3ull;
+    return (size_t)h;
+  }
+};
+
+// per output file; parts are streamed through it rather than built up in memory
+constexpr size_t OUT_BUFFER = size_t{1} << 16;
+
+uint64_t pin_key(Symbol cell, Symbol port) { return (uint64_t)cell << 32 | port; }
+
+void put_json_string(std::ostream& os, std::string_view s) {
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') os << '\\' << c;
+    else if ((unsigned char)c < 0x20) { char buf[8]; std::snprintf(buf, sizeof buf, "\\u%04x", (unsigned)c); os << buf; }
+    else os << c;
+  }
+  os << '"';
+}
+
+// read_json takes names starting with '$' as yosys-internal; ports and wires stay public
+std::string public_name(std::string_view name) {
+  return name.starts_with('$') ? "\\" + std::string(name) : std::string(name);
+}
+
+// What a cell pin is connected to in Verilog. Its signal bits come from src, a port of the
+// part as wide as the whole pin (bit b of the pin is src[b]) or an internal wire holding the
+// signal bits only (the i-th signal bit is src[i]); constants are spliced in where they sit.
+void put_verilog_pin(std::ostream& os, const PortInfo& P, std::string_view src, int src_width, bool whole_pin) {
+  if (P.const_bits.empty()) { os << src; return; }
+  std::vector<std::string> runs;                  // MSB first
+  int signal = (int)P.bits.size();                // signal bits below b + 1
+  for (int b = P.width - 1; b >= 0;) {
+    if (P.const_bits[b]) {
+      std::string lit;
+      for (; b >= 0 && P.const_bits[b]; --b) lit.push_back(P.const_bits[b]);
+      runs.push_back(std::to_string(lit.size()) + "'b" + lit);
+      continue;
+    }
+    const int hi = whole_pin ? b : signal - 1;
+    for (; b >= 0 && !P.const_bits[b]; --b) --signal;
+    const int lo = whole_pin ? b + 1 : signal;
+    std::string run(src);
+    if (src_width > 1) run += "[" + std::to_string(hi) + (hi == lo ? "" : ":" + std::to_string(lo)) + "]";
+    runs.push_back(std::move(run));
+  }
+  if (runs.size() == 1) { os << runs.front(); return; }
+  os << "{";
+  for (size_t i = 0; i < runs.size(); ++i) os << (i ? ", " : "") << runs[i];
+  os << "}";
+}
+
+// an integer parameter as yosys writes it (a binary string) or as a plain number; -1 otherwise
+long long param_int(std::string_view text) {
+  if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+    text = text.substr(1, text.size() - 2);
+    if (text.empty() || text.size() > 62 || text.find_first_not_of("01") != std::string_view::npos) return -1;
+    long long v = 0;
+    for (char c : text) v = v * 2 + (c - '0');
+    return v;
+  }
+  long long v = -1;
+  const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), v);
+  return ec == std::errc() && ptr == text.data() + text.size() ? v : -1;
+}
+
+// yosys read_json rejects a cell whose connection is not as wide as its <PORT>_WIDTH
+void check_pin_widths(const CellInfo& C, const global::SymbolTable& S) {
+  constexpr std::string_view suffix = "_WIDTH";
+  for (const auto& [pname, value] : C.params) {
+    const auto name = S.str(pname);
+    if (!name.ends_with(suffix)) continue;
+    const auto port = name.substr(0, name.size() - suffix.size());
+    for (const auto& P : C.ports) {
+      if (S.str(P.name) != port) continue;
+      const auto expect = param_int(S.str(value));
+      if (expect >= 0 && expect != P.width) {
+        throw std::runtime_error("cell " + std::string(S.str(C.name)) + ": connection " + std::string(port) + " is "
+                                 + std::to_string(P.width) + " bits wide, " + std::string(name) + " is " + std::to_string(expect));
+      }
+    }
   }
-  return os.str();
+}
+
 }
 
 ModuleInfo Writer::parse_json(const std::string& json_path) {
-  std::ifstream in(json_path);
-  if (!in.good()) throw std::runtime_error("cannot open json: " + json_path);
-  std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::unique_ptr<global::MappedFile> input;
+  try {
+    input = std::make_unique<global::MappedFile>(json_path);
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error("cannot open json: " + json_path + " (" + e.what() + ")");
+  }
   Json::CharReaderBuilder builder;
   std::string errs;
   Json::Value root;
   std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-  bool ok = reader->parse(content.data(), content.data() + content.size(), &root, &errs);
+  // parse straight from the mapped pages, no intermediate copy of the file
+  bool ok = reader->parse(input->data(), input->data() + input->size(), &root, &errs);
   if (!ok) throw std::runtime_error("json parse failed: " + errs);
 
   const auto& modules = root["modules"];
@@ -46,6 +156,7 @@ ModuleInfo Writer::parse_json(const std::string& json_path) {
   }
 
   ModuleInfo M; M.name = top;
+  auto& S = M.symbols;
   const auto& mod = modules[top];
   global::log_info(std::string("top=") + M.name);
 
@@ -53,8 +164,8 @@ ModuleInfo Writer::parse_json(const std::string& json_path) {
   for (const auto& pname : ports.getMemberNames()) {
     const auto& pval = ports[pname];
     PortInfo p;
-    p.name = pname;
-    p.direction = pval["direction"].asString();
+    p.name = S.intern(pname);
+    p.direction = S.intern(pval["direction"].asString());
     for (const auto& v : pval["bits"]) {
       if (v.isInt()) p.bits.push_back(v.asInt());
       else if (v.isUInt()) p.bits.push_back((int)v.asUInt());
@@ -63,31 +174,85 @@ ModuleInfo Writer::parse_json(const std::string& json_path) {
   }
   global::log_info(std::string("ports=") + std::to_string(M.ports.size()));
 
+  // parameter values are kept as JSON text, ready to be written out again
+  Json::StreamWriterBuilder compact;
+  compact["indentation"] = "";
   const auto& cells = mod["cells"];
   for (const auto& cname : cells.getMemberNames()) {
     const auto& cval = cells[cname];
-    CellInfo C; C.name = cname; C.type = cval["type"].asString();
+    CellInfo C; C.name = S.intern(cname); C.type = S.intern(cval["type"].asString());
     const auto& dirs = cval["port_directions"];
     const auto& conns = cval["connections"];
     for (const auto& dname : conns.getMemberNames()) {
-      PortInfo p; p.name = dname; p.direction = dirs[dname].asString();
+      PortInfo p; p.name = S.intern(dname); p.direction = S.intern(dirs[dname].asString());
       int w = 0;
       for (const auto& v : conns[dname]) {
-        if (v.isInt()) { p.bits.push_back(v.asInt()); ++w; }
-        else if (v.isUInt()) { p.bits.push_back((int)v.asUInt()); ++w; }
+        if (v.isInt()) { p.bits.push_back(v.asInt()); p.const_bits.push_back(0); ++w; }
+        else if (v.isUInt()) { p.bits.push_back((int)v.asUInt()); p.const_bits.push_back(0); ++w; }
         else if (v.isString()) { const auto s = v.asString(); char c = (s.empty() ? '0' : s[0]); p.const_bits.push_back(c); ++w; }
       }
       p.width = w;
+      if (p.bits.size() == (size_t)w) p.const_bits.clear();    // signal bits only
+      C.ports.push_back(std::move(p));
+    }
+    const auto& params = cval["parameters"];
+    for (const auto& pname : params.getMemberNames()) {
+      C.params.emplace_back(S.intern(pname), S.intern(Json::writeString(compact, params[pname])));
+    }
+    M.cells.push_back(std::move(C));
+  }
+  global::log_info(std::string("cells=") + std::to_string(M.cells.size()));
+  return M;
+}
+
+ModuleInfo Writer::load_snapshot(const std::string& path) {
+  // the mapping is dropped once the tables are copied out
+  const global::NetlistSnapshot snap(path);
+  global::log_info(std::string("snapshot source hash=") + std::to_string(snap.source_hash()));
+  // signals go to bits, constants to const_bits in place, as parse_json sorts json ints and strings
+  const auto split_bits = [&](const global::SnapshotPort& sp, PortInfo& p) {
+    for (auto b : snap.bits(sp)) {
+      if (b >= global::SNAPSHOT_CONST_0) p.const_bits.push_back("01xz"[b - global::SNAPSHOT_CONST_0]);
+      else { p.bits.push_back((int)b); p.const_bits.push_back(0); }
+    }
+    if (p.bits.size() == p.const_bits.size()) p.const_bits.clear();
+  };
+
+  ModuleInfo M; M.name = std::string(snap.top_name());
+  auto& S = M.symbols;
+  global::log_info(std::string("top=") + M.name);
+
+  M.ports.reserve(snap.ports().size());
+  for (const auto& sp : snap.ports()) {
+    PortInfo p;
+    p.name = S.intern(snap.str(sp.name));
+    p.direction = S.intern(global::direction_name(sp.direction));
+    split_bits(sp, p);
+    p.const_bits.clear();           // parse_json keeps only the signal bits of module ports
+    M.ports.push_back(std::move(p));
+  }
+  global::log_info(std::string("ports=") + std::to_string(M.ports.size()));
+
+  M.cells.reserve(snap.cells().size());
+  for (const auto& sc : snap.cells()) {
+    CellInfo C; C.name = S.intern(snap.str(sc.name)); C.type = S.intern(snap.str(sc.type));
+    C.ports.reserve(sc.pin_count);
+    for (const auto& sp : snap.pins(sc)) {
+      PortInfo p; p.name = S.intern(snap.str(sp.name)); p.direction = S.intern(global::direction_name(sp.direction));
+      split_bits(sp, p);
+      p.width = (int)sp.bit_count;
       C.ports.push_back(std::move(p));
     }
+    C.params.reserve(sc.param_count);
+    for (const auto& sp : snap.params(sc)) C.params.emplace_back(S.intern(snap.str(sp.name)), S.intern(snap.str(sp.value)));
     M.cells.push_back(std::move(C));
   }
   global::log_info(std::string("cells=") + std::to_string(M.cells.size()));
   return M;
 }
 
-std::unordered_map<int, std::string> Writer::read_vertices_map(const std::string& path) {
-  std::unordered_map<int, std::string> id2cell;
+std::unordered_map<int, Symbol> Writer::read_vertices_map(const std::string& path, global::SymbolTable& symbols) {
+  std::unordered_map<int, Symbol> id2cell;
   std::ifstream in(path);
   if (!in.good()) throw std::runtime_error("cannot open vertices map: " + path);
   std::string line;
@@ -96,14 +261,14 @@ std::unordered_map<int, std::string> Writer::read_vertices_map(const std::string
     std::istringstream iss(line);
     int vid; std::string cell;
     if (!(iss >> vid >> cell)) continue;
-    id2cell[vid] = cell;
+    id2cell[vid] = symbols.intern(cell);
   }
   global::log_info(std::string("vertices_map entries=") + std::to_string(id2cell.size()));
   return id2cell;
 }
 
-std::unordered_map<std::string, int> Writer::build_cell_part_map(const std::string& part_file, const std::unordered_map<int, std::string>& id2cell) {
-  std::unordered_map<std::string, int> cell2part;
+std::unordered_map<Symbol, int> Writer::build_cell_part_map(const std::string& part_file, const std::unordered_map<int, Symbol>& id2cell) {
+  std::unordered_map<Symbol, int> cell2part;
   std::ifstream in(part_file);
   if (!in.good()) throw std::runtime_error("cannot open partition file: " + part_file);
   std::string line; int idx = 1;
@@ -118,96 +283,255 @@ std::unordered_map<std::string, int> Writer::build_cell_part_map(const std::stri
   return cell2part;
 }
 
+// cells missing from the partition file go to part 0
+int Writer::part_of(Symbol cell) const {
+  auto itp = cell2part_.find(cell);
+  return itp != cell2part_.end() ? itp->second : 0;
+}
+
+// Parts only read the shared tables (M_, net2conns_, net_wire_), so they are written
+// concurrently, each streamed into its own file. What a part logs is held back and
+// written in part-id order as soon as all earlier parts are done, so the log does not depend
+// on scheduling and only the logs of parts still waiting for an earlier one are kept.
 void Writer::generate_modules(const std::string& out_dir) {
-  for (auto& kvp : parts_) {
-    int p = kvp.first;
-    auto& PD = kvp.second;
-    std::ostringstream os;
-    std::string modname = M_.name + std::string("_part") + std::to_string(p);
-    struct PortDecl { std::string name; std::string dir; int width; };
-    std::vector<PortDecl> portdecls;
-    std::unordered_map<std::string, std::string> internal_alias; // netkey -> internal wire name
-    std::unordered_map<std::string, std::string> conn_alias; // netkey|cell|port -> module port name
-    int net_idx = 0;
-    for (const auto& nk : PD.nets) {
-      const std::string& netkey = nk.first;
-      const auto& u = nk.second;
-      size_t total_conns = net2conns_[netkey].size();
-      size_t local_conns = u.cells.size();
-      bool is_cut = !(local_conns == total_conns);
-      global::log_debug(std::string("net ") + netkey + (is_cut ? " cut" : " internal"));
-      if (is_cut) {
-        const auto& conns = net2conns_[netkey];
-        for (const auto& c : conns) {
-          if (c.cell == "$top") continue;
-          auto itp = cell2part_.find(c.cell);
-          int cp = (itp != cell2part_.end()) ? itp->second : 0;
-          if (cp != p) continue;
-          std::string pname = c.cell + std::string("_") + c.port;
-          portdecls.push_back({pname, c.dir, c.width});
-          conn_alias[netkey + std::string("|") + c.cell + std::string("|") + c.port] = pname;
-          global::log_debug(std::string("  port ") + pname + std::string(" width=") + std::to_string(c.width) + std::string(" dir=") + c.dir);
+  std::vector<std::pair<int, const PartDesign*>> parts;
+  parts.reserve(parts_.size());
+  for (const auto& kvp : parts_) parts.emplace_back(kvp.first, &kvp.second);
+  std::sort(parts.begin(), parts.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  const auto n = parts.size();
+  std::vector<global::LogBuffer> logs(n);
+  std::vector<std::exception_ptr> errors(n);
+  std::vector<char> done(n, 0);
+  std::mutex flush_mutex;
+  size_t flushed = 0;               // logs [0, flushed) are written; stops after a failed part
+  {
+    const auto threads = threads_ == 0 ? global::default_threads() : threads_;
+    global::ThreadPool pool(std::min(threads, std::max<size_t>(n, 1)));
+    pool.parallel_for(n, [&](size_t i) {
+      {
+        global::ScopedLogBuffer capture(logs[i]);
+        try {
+          write_module(parts[i].first, *parts[i].second, out_dir);
+        } catch (...) {
+          errors[i] = std::current_exception();
         }
-      } else {
-        std::string nname = std::string("net_") + std::to_string(net_idx++);
-        internal_alias[netkey] = nname;
-        global::log_debug(std::string("  internal wire ") + nname + std::string(" width=") + std::to_string(u.width));
       }
-    }
+      std::lock_guard<std::mutex> lk(flush_mutex);
+      done[i] = 1;
+      while (flushed < n && done[flushed] && (flushed == 0 || !errors[flushed - 1])) {
+        global::flush_log(logs[flushed]);
+        global::LogBuffer().swap(logs[flushed]);
+        ++flushed;
+      }
+    });
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if (errors[i]) std::rethrow_exception(errors[i]);
+  }
+}
 
-    os << "module " << modname << " (\n";
-    for (size_t i = 0; i < portdecls.size(); ++i) {
-      os << "    " << portdecls[i].name;
-      if (i + 1 < portdecls.size()) os << ",";
-      os << "\n";
+void Writer::write_module(int p, const PartDesign& PD, const std::string& out_dir) const {
+  std::string modname = M_.name + std::string("_part") + std::to_string(p);
+  const auto& S = M_.symbols;
+  std::vector<PortDecl> portdecls;
+  // a cell port sits on exactly one net, so the alias needs no net
+  PinAlias conn_alias;
+  for (const auto& [net, u] : PD.nets) {
+    global::log_debug(std::string("net ") + normalize_bits(*net_bits_[net]) + (u.cut ? " cut" : " internal"));
+    if (u.cut) {
+      const auto& conns = net2conns_[net];
+      for (uint32_t k = u.first; k < u.first + u.count; ++k) {
+        const auto& c = conns[k];
+        std::string pname = S.string(c.cell) + std::string("_") + S.string(c.port);
+        portdecls.push_back({pname, c.dir, c.width});
+        conn_alias[pin_key(c.cell, c.port)] = portdecls.size() - 1;
+        global::log_debug(std::string("  port ") + pname + std::string(" width=") + std::to_string(c.width) + std::string(" dir=") + S.string(c.dir));
+      }
+    } else {
+      global::log_debug(std::string("  internal wire net_") + std::to_string(net_wire_[net]) + std::string(" width=") + std::to_string(u.width));
     }
-    os << ");\n";
+  }
 
-    for (const auto& pd : portdecls) {
-      if (pd.width > 1) os << pd.dir << " [" << (pd.width - 1) << ":0] " << pd.name << ";\n";
-      else os << pd.dir << " " << pd.name << ";\n";
-    }
+  // streamed into the file through a buffer of fixed size, the text is never held whole
+  const bool json = format_ == OutputFormat::JSON;
+  std::string outpath = out_dir + "/" + modname + (json ? ".json" : ".v");
+  std::unique_ptr<char[]> buf(new char[OUT_BUFFER]);
+  std::ofstream outf;
+  outf.rdbuf()->pubsetbuf(buf.get(), OUT_BUFFER);
+  outf.open(outpath);
+  if (!outf.good()) {
+    throw std::runtime_error(std::string("cannot write: ") + outpath);
+  }
+  if (json) json_module(outf, modname, PD, portdecls, conn_alias);
+  else verilog_module(outf, modname, PD, portdecls, conn_alias);
+  outf.close();
+  if (!outf) {
+    throw std::runtime_error(std::string("cannot write: ") + outpath);
+  }
+  if (ready_) {
+    std::lock_guard<std::mutex> lk(ready_mutex_);
+    *ready_ << outpath << std::endl;
+  }
+  global::log_info(std::string("write ") + outpath + std::string(" ports=") + std::to_string(portdecls.size()) + std::string(" cells=") + std::to_string(PD.cells.size()));
+}
 
-    for (const auto& nk : PD.nets) {
-      const auto& netkey = nk.first; const auto& u = nk.second;
-      auto it = internal_alias.find(netkey);
-      if (it != internal_alias.end()) {
-        const auto& nname = it->second;
-        if (u.width > 1) os << "wire [" << (u.width - 1) << ":0] " << nname << ";\n";
-        else os << "wire " << nname << ";\n";
-      }
-    }
+void Writer::verilog_module(std::ostream& os, const std::string& modname, const PartDesign& PD,
+                            const std::vector<PortDecl>& portdecls, const PinAlias& conn_alias) const {
+  const auto& S = M_.symbols;
+  os << "module " << modname << " (\n";
+  for (size_t i = 0; i < portdecls.size(); ++i) {
+    os << "    " << portdecls[i].name;
+    if (i + 1 < portdecls.size()) os << ",";
+    os << "\n";
+  }
+  os << ");\n";
 
-    for (const auto& C : PD.cells) {
-      os << C.type << " " << C.name << " (\n";
-      for (size_t i = 0; i < C.ports.size(); ++i) {
-        const auto& P = C.ports[i];
-        if (P.bits.empty() && !P.const_bits.empty()) {
-          if (P.width <= 1) { char b = P.const_bits[0]; os << "    ." << P.name << "(1'b" << b << ")"; }
-          else { std::string pat; pat.reserve(P.width); for (char c : P.const_bits) pat.push_back(c); os << "    ." << P.name << "(" << P.width << "'b" << pat << ")"; }
+  for (const auto& pd : portdecls) {
+    if (pd.width > 1) os << S.str(pd.dir) << " [" << (pd.width - 1) << ":0] " << pd.name << ";\n";
+    else os << S.str(pd.dir) << " " << pd.name << ";\n";
+  }
+
+  for (const auto& nk : PD.nets) {
+    const auto& u = nk.second;
+    const int w = net_wire_[nk.first];
+    if (w < 0) continue;
+    if (u.width > 1) os << "wire [" << (u.width - 1) << ":0] net_" << w << ";\n";
+    else os << "wire net_" << w << ";\n";
+  }
+
+  for (uint32_t ci : PD.cells) {
+    const auto& C = M_.cells[ci];
+    os << S.str(C.type) << " " << S.str(C.name) << " (\n";
+    for (size_t i = 0; i < C.ports.size(); ++i) {
+      const auto& P = C.ports[i];
+      if (P.bits.empty() && !P.const_bits.empty()) {
+        os << "    ." << S.str(P.name) << "(";
+        put_verilog_pin(os, P, {}, 0, false);
+        os << ")";
+      } else {
+        auto ca = conn_alias.find(pin_key(C.name, P.name));
+        if (ca != conn_alias.end()) {
+          const auto& pd = portdecls[ca->second];
+          os << "    ." << S.str(P.name) << "(";
+          put_verilog_pin(os, P, pd.name, pd.width, true);
+          os << ")";
         } else {
-          std::string key = normalize_bits(P.bits);
-          auto ca = conn_alias.find(key + std::string("|") + C.name + std::string("|") + P.name);
-          if (ca != conn_alias.end()) { os << "    ." << P.name << "(" << ca->second << ")"; }
-          else { auto ia = internal_alias.find(key); if (ia == internal_alias.end()) continue; os << "    ." << P.name << "(" << ia->second << ")"; }
+          const int w = P.net < 0 ? -1 : net_wire_[P.net];
+          if (w < 0) continue;
+          os << "    ." << S.str(P.name) << "(";
+          put_verilog_pin(os, P, "net_" + std::to_string(w), (int)P.bits.size(), false);
+          os << ")";
         }
-        if (i + 1 < C.ports.size()) os << ",";
-        os << "\n";
       }
-      os << ");\n";
+      if (i + 1 < C.ports.size()) os << ",";
+      os << "\n";
     }
+    os << ");\n";
+  }
+
+  os << "endmodule\n";
+}
+
+// The part as a yosys write_json netlist. Ports and wires are the ones of the Verilog
+// output; their signal bits are numbered afresh from 2 (0 and 1 are taken by yosys), while
+// cell types, parameters and constant bits (in place within each connection) are passed on
+// unchanged, so every connection stays as wide as the cell's *_WIDTH parameters say.
+void Writer::json_module(std::ostream& os, const std::string& modname, const PartDesign& PD,
+                         const std::vector<PortDecl>& portdecls, const PinAlias& conn_alias) const {
+  const auto& S = M_.symbols;
+  int next_bit = 2;
+  std::vector<int> port_bit(portdecls.size());
+  for (size_t i = 0; i < portdecls.size(); ++i) { port_bit[i] = next_bit; next_bit += portdecls[i].width; }
+  std::vector<int> wire_bit(PD.wires), wire_width(PD.wires);
+  for (const auto& [net, u] : PD.nets) {
+    const int w = net_wire_[net];
+    if (w < 0) continue;
+    wire_bit[w] = next_bit; wire_width[w] = u.width;
+    next_bit += u.width;
+  }
+  const auto put_bits = [&](int first, int width) {
+    os << "[";
+    for (int b = 0; b < width; ++b) os << (b ? ", " : " ") << first + b;
+    os << " ]";
+  };
 
-    os << "endmodule\n";
+  os << "{\n  \"creator\": \"partition2verilog\",\n  \"modules\": {\n    ";
+  put_json_string(os, modname);
+  os << ": {\n      \"attributes\": {\n        \"top\": \"00000000000000000000000000000001\"\n      },\n      \"ports\": {";
+  for (size_t i = 0; i < portdecls.size(); ++i) {
+    os << (i ? ",\n" : "\n") << "        ";
+    put_json_string(os, public_name(portdecls[i].name));
+    os << ": {\n          \"direction\": \"" << S.str(portdecls[i].dir) << "\",\n          \"bits\": ";
+    put_bits(port_bit[i], portdecls[i].width);
+    os << "\n        }";
+  }
+  os << "\n      },\n      \"cells\": {";
+
+  // connected pins of a cell: first bit of the port (bit b of the pin is first + b) or of the
+  // wire (signal bit i is first + i), -1 for a constant
+  struct Pin { const PortInfo* port; int first; bool whole_pin; };
+  std::vector<Pin> pins;
+  for (size_t c = 0; c < PD.cells.size(); ++c) {
+    const auto& C = M_.cells[PD.cells[c]];
+    pins.clear();
+    for (const auto& P : C.ports) {
+      if (P.bits.empty() && !P.const_bits.empty()) { pins.push_back({&P, -1, false}); continue; }
+      auto ca = conn_alias.find(pin_key(C.name, P.name));
+      if (ca != conn_alias.end()) { pins.push_back({&P, port_bit[ca->second], true}); continue; }
+      const int w = P.net < 0 ? -1 : net_wire_[P.net];
+      if (w >= 0) pins.push_back({&P, wire_bit[w], false});
+    }
 
-    std::string outpath = out_dir + "/" + modname + ".v";
-    std::ofstream outf(outpath);
-    if (!outf.good()) {
-      throw std::runtime_error(std::string("cannot write: ") + outpath);
+    const auto name = S.str(C.name);
+    os << (c ? ",\n" : "\n") << "        ";
+    put_json_string(os, name);
+    os << ": {\n          \"hide_name\": " << (name.starts_with('$') ? 1 : 0) << ",\n          \"type\": ";
+    put_json_string(os, S.str(C.type));
+    os << ",\n          \"parameters\": {";
+    for (size_t i = 0; i < C.params.size(); ++i) {
+      os << (i ? ",\n" : "\n") << "            ";
+      put_json_string(os, S.str(C.params[i].first));
+      os << ": " << S.str(C.params[i].second);
+    }
+    os << (C.params.empty() ? "" : "\n          ") << "},\n          \"port_directions\": {";
+    for (size_t i = 0; i < pins.size(); ++i) {
+      os << (i ? ",\n" : "\n") << "            ";
+      put_json_string(os, S.str(pins[i].port->name));
+      os << ": \"" << S.str(pins[i].port->direction) << "\"";
     }
-    outf << os.str();
-    outf.flush();
-    global::log_info(std::string("write ") + outpath + std::string(" ports=") + std::to_string(portdecls.size()) + std::string(" cells=") + std::to_string(PD.cells.size()));
+    os << (pins.empty() ? "" : "\n          ") << "},\n          \"connections\": {";
+    for (size_t i = 0; i < pins.size(); ++i) {
+      const auto& [P, first, whole_pin] = pins[i];
+      os << (i ? ",\n" : "\n") << "            ";
+      put_json_string(os, S.str(P->name));
+      os << ": ";
+      if (P->const_bits.empty()) { put_bits(first, P->width); continue; }
+      os << "[";
+      for (int b = 0, signal = 0; b < P->width; ++b) {
+        os << (b ? ", " : " ");
+        if (const char k = P->const_bits[b]) os << '"' << k << '"';
+        else os << first + (whole_pin ? b : signal++);
+      }
+      os << " ]";
+    }
+    os << (pins.empty() ? "" : "\n          ") << "}\n        }";
   }
+  os << "\n      },\n      \"netnames\": {";
+
+  bool first_net = true;
+  const auto put_net = [&](std::string_view name, int bit, int width) {
+    os << (first_net ? "\n" : ",\n") << "        ";
+    first_net = false;
+    put_json_string(os, name);
+    os << ": {\n          \"hide_name\": 0,\n          \"bits\": ";
+    put_bits(bit, width);
+    os << "\n        }";
+  };
+  for (size_t i = 0; i < portdecls.size(); ++i) put_net(public_name(portdecls[i].name), port_bit[i], portdecls[i].width);
+  for (int w = 0; w < PD.wires; ++w) put_net("net_" + std::to_string(w), wire_bit[w], wire_width[w]);
+  os << "\n      }\n    }\n  }\n}\n";
 }
 
 int Writer::run(const std::string& json_path,
@@ -218,52 +542,71 @@ int Writer::run(const std::string& json_path,
   global::log_info(std::string("vertices=") + vertices_txt);
   global::log_info(std::string("part=") + part_file);
   global::log_info(std::string("out_dir=") + out_dir);
-  M_ = parse_json(json_path);
-  id2cell_ = read_vertices_map(vertices_txt);
-  cell2part_ = build_cell_part_map(part_file, id2cell_);
-
-  for (const auto& C : M_.cells) {
-    int p = 0;
-    auto itp = cell2part_.find(C.name);
-    if (itp != cell2part_.end()) p = itp->second;
-    parts_[p].cells.push_back(C);
+  // a snapshot written by verilog2kahypar --snapshot saves parsing the JSON again
+  bool snapshot = false;
+  {
+    std::ifstream probe(json_path, std::ios::binary);
+    char head[sizeof(global::SnapshotHeader)] = {};
+    probe.read(head, sizeof head);
+    snapshot = global::NetlistSnapshot::is_snapshot(std::string_view(head, (size_t)probe.gcount()));
   }
-  global::log_info(std::string("parts=") + std::to_string(parts_.size()));
+  M_ = snapshot ? load_snapshot(json_path) : parse_json(json_path);
+  id2cell_ = read_vertices_map(vertices_txt, M_.symbols);
+  cell2part_ = build_cell_part_map(part_file, id2cell_);
 
-  for (const auto& C : M_.cells) {
-    for (const auto& P : C.ports) {
+  // nets are numbered in order of first appearance: cell pins, then module ports
+  std::unordered_map<std::vector<int>, NetId, BitsHash> net_ids;
+  const auto net_of = [&](const std::vector<int>& bits) {
+    const auto [it, added] = net_ids.try_emplace(bits, (NetId)net2conns_.size());
+    if (added) { net2conns_.emplace_back(); net_bits_.push_back(&it->first); }
+    return it->second;
+  };
+  // parts refer to their cells by index, the cells themselves stay in M_
+  for (uint32_t ci = 0; ci < (uint32_t)M_.cells.size(); ++ci) {
+    auto& C = M_.cells[ci];
+    check_pin_widths(C, M_.symbols);
+    const int part = part_of(C.name);
+    parts_[part].cells.push_back(ci);
+    for (auto& P : C.ports) {
       if (P.bits.empty()) continue;
-      std::string key = normalize_bits(P.bits);
-      net2conns_[key].push_back({C.name, P.name, P.direction, (int)P.bits.size()});
+      P.net = net_of(P.bits);
+      net2conns_[P.net].push_back({C.name, P.name, P.direction, P.width, part});
     }
   }
-  for (const auto& P : M_.ports) {
+  for (auto& P : M_.ports) {
     if (P.bits.empty()) continue;
-    std::string key = normalize_bits(P.bits);
-    net2conns_[key].push_back({"$top", P.name, P.direction, (int)P.bits.size()});
+    P.net = net_of(P.bits);
+    net2conns_[P.net].push_back({M_.top, P.name, P.direction, (int)P.bits.size(), -1});
   }
+
+  global::log_info(std::string("parts=") + std::to_string(parts_.size()));
   global::log_info(std::string("nets=") + std::to_string(net2conns_.size()));
 
-  for (const auto& kv : net2conns_) {
-    const std::string& netkey = kv.first;
-    const auto& conns = kv.second;
-    int width = conns.empty() ? 1 : conns.front().width;
-    std::unordered_map<int, NetUse> uses;
-    for (const auto& c : conns) {
-      if (c.cell == "$top") continue;
-      int p = 0;
-      auto itp = cell2part_.find(c.cell);
-      if (itp != cell2part_.end()) p = itp->second;
-      auto& u = uses[p];
+  // One pass over all pins: the pins of every net are grouped by part, so a part finds
+  // its pins of a net as one range and never rescans the others. Nets are visited in
+  // order, so every part lists its nets sorted by id.
+  net_wire_.assign(net2conns_.size(), -1);
+  const auto by_part = [](const Conn& a, const Conn& b) { return (unsigned)a.part < (unsigned)b.part; };  // module ports last
+  for (NetId net = 0; net < (NetId)net2conns_.size(); ++net) {
+    auto& conns = net2conns_[net];
+    const int width = (int)net_bits_[net]->size();     // an internal wire carries the signal bits only
+    // stable: the pins of a part keep their order, which is the order of its port list
+    if (!std::is_sorted(conns.begin(), conns.end(), by_part)) std::stable_sort(conns.begin(), conns.end(), by_part);
+    for (size_t i = 0; i < conns.size() && conns[i].part >= 0;) {
+      const int p = conns[i].part;
+      NetUse u;
       u.width = width;
-      u.cells.insert(c.cell);
-      if (c.dir == "input") u.inside_inputs.insert(c.cell);
-      else if (c.dir == "output") u.inside_outputs.insert(c.cell);
-      else { u.inside_inputs.insert(c.cell); u.inside_outputs.insert(c.cell); }
-    }
-    for (auto& pu : uses) {
-      int p = pu.first; auto& u = pu.second;
-      parts_[p].nets[netkey] = u;
+      u.first = (uint32_t)i;
+      // the pins of a cell are added together, so pins of the same cell are adjacent
+      size_t cells = 0;
+      for (; i < conns.size() && conns[i].part == p; ++i) {
+        if (i == u.first || conns[i].cell != conns[i - 1].cell) ++cells;
+      }
+      u.count = (uint32_t)(i - u.first);
+      u.cut = cells != conns.size();
+      auto& PD = parts_[p];
+      if (!u.cut) net_wire_[net] = PD.wires++;
+      PD.nets.emplace_back(net, u);
     }
   }
 
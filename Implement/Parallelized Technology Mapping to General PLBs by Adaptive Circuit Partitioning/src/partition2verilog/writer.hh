@@ -1,43 +1,71 @@
 #pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
+#include "../global/symbol_table.hh"
+
+// names (cells, types, ports, directions) are symbols of ModuleInfo::symbols
+using global::Symbol;
+// nets are numbered by their bit vector, densely from 0
+using NetId = int;
 
 struct PortInfo {
-  std::string name;
-  std::string direction;
-  std::vector<int> bits;
-  int width = 0;
+  Symbol name = global::NO_SYMBOL;
+  Symbol direction = global::NO_SYMBOL;
+  std::vector<int> bits;          // signal bits in pin order; they identify the net
+  int width = 0;                  // of the whole pin, constants included
+  // empty when the pin has signal bits only; otherwise one entry per pin bit, LSB first:
+  // '0' '1' 'x' 'z' for a constant, 0 where the next signal bit goes
   std::vector<char> const_bits;
+  NetId net = -1;                 // -1: no signal bits
 };
 
 struct CellInfo {
-  std::string name;
-  std::string type;
+  Symbol name = global::NO_SYMBOL;
+  Symbol type = global::NO_SYMBOL;
   std::vector<PortInfo> ports;
+  std::vector<std::pair<Symbol, Symbol>> params;  // name, value as JSON text
 };
 
 struct ModuleInfo {
+  ModuleInfo();
+
   std::string name;
+  global::SymbolTable symbols;
+  Symbol top, input, output;      // "$top" (module port pseudo cell) and the two directions
   std::vector<CellInfo> cells;
   std::vector<PortInfo> ports;
 };
 
+// a net as seen from one part; its pins there are net2conns_[net][first, first + count)
 struct NetUse {
-  int width = 0;
-  std::unordered_set<std::string> inside_inputs;
-  std::unordered_set<std::string> inside_outputs;
-  std::unordered_set<std::string> cells;
+  int width = 0;                  // signal bits of the net
+  uint32_t first = 0;
+  uint32_t count = 0;
+  bool cut = false;               // has pins outside the part (or on the module ports)
 };
 
 struct PartDesign {
-  std::vector<CellInfo> cells;
-  std::unordered_map<std::string, NetUse> nets;
+  std::vector<uint32_t> cells;                    // indices into ModuleInfo::cells
+  std::vector<std::pair<NetId, NetUse>> nets;     // sorted by net
+  int wires = 0;                                  // internal nets, declared as net_0 ..
 };
 
+// VERILOG: one .v per part; JSON: one yosys JSON netlist per part (read_json), which
+// keeps the cell parameters and spares yosys its Verilog front end
+enum class OutputFormat { VERILOG, JSON };
+
 class Writer {
 public:
+  void set_threads(size_t threads) { threads_ = threads; }   // 0: one per core
+  void set_format(OutputFormat format) { format_ = format; }
+  // every finished output file is written to out, one path per line, as soon as it is
+  // closed, so a consumer (e.g. the synthesis jobs) can start on it while the rest is written
+  void set_ready(std::ostream* out) { ready_ = out; }
   int run(const std::string& json_path,
           const std::string& vertices_txt,
           const std::string& part_file,
@@ -46,15 +74,30 @@ public:
 private:
   static std::string normalize_bits(const std::vector<int>& bits);
   static ModuleInfo parse_json(const std::string& json_path);
-  static std::unordered_map<int, std::string> read_vertices_map(const std::string& path);
-  static std::unordered_map<std::string, int> build_cell_part_map(const std::string& part_file,
-                                                                  const std::unordered_map<int, std::string>& id2cell);
+  static ModuleInfo load_snapshot(const std::string& path);
+  static std::unordered_map<int, Symbol> read_vertices_map(const std::string& path, global::SymbolTable& symbols);
+  static std::unordered_map<Symbol, int> build_cell_part_map(const std::string& part_file,
+                                                             const std::unordered_map<int, Symbol>& id2cell);
+  int part_of(Symbol cell) const;
   void generate_modules(const std::string& out_dir);
+  struct PortDecl { std::string name; Symbol dir; int width; };
+  using PinAlias = std::unordered_map<std::uint64_t, size_t>;   // (cell, port) -> index into the PortDecls
+  void write_module(int p, const PartDesign& PD, const std::string& out_dir) const;
+  void verilog_module(std::ostream& os, const std::string& modname, const PartDesign& PD,
+                      const std::vector<PortDecl>& portdecls, const PinAlias& conn_alias) const;
+  void json_module(std::ostream& os, const std::string& modname, const PartDesign& PD,
+                   const std::vector<PortDecl>& portdecls, const PinAlias& conn_alias) const;
 
+  size_t threads_ = 0;
+  OutputFormat format_ = OutputFormat::VERILOG;
+  std::ostream* ready_ = nullptr;
+  mutable std::mutex ready_mutex_;
   ModuleInfo M_;
-  std::unordered_map<int, std::string> id2cell_;
-  std::unordered_map<std::string, int> cell2part_;
+  std::unordered_map<int, Symbol> id2cell_;
+  std::unordered_map<Symbol, int> cell2part_;
   std::unordered_map<int, PartDesign> parts_;
-  struct Conn { std::string cell; std::string port; std::string dir; int width; };
-  std::unordered_map<std::string, std::vector<Conn>> net2conns_;
+  struct Conn { Symbol cell; Symbol port; Symbol dir; int width; int part; };   // width of the whole pin; part -1: module port
+  std::vector<std::vector<Conn>> net2conns_;                 // index is the net, pins grouped by part
+  std::vector<const std::vector<int>*> net_bits_;           // bits of each net, for the log
+  std::vector<int> net_wire_;   // internal nets: wire index in the one part holding them, else -1
 };
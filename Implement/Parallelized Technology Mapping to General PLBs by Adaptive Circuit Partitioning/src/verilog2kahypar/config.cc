@@ -1,9 +1,11 @@
 #include "config.hh"
+#include <algorithm>
 #include <cstddef>
-#include <memory>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include "../global/debug.hh"
 
 
@@ -19,12 +21,31 @@ std::string port_dir_to_string(PortDirection direction) {
 }
 
 
+auto const_bit(std::string_view value) -> Bit {
+    if (value == "0") return BIT_CONST_0;
+    if (value == "1") return BIT_CONST_1;
+    if (value == "x") return BIT_CONST_X;
+    if (value == "z") return BIT_CONST_Z;
+    throw std::runtime_error("unknown constant bit value: " + std::string(value));
+}
+
+auto bit_to_string(Bit b) -> std::string {
+    switch (b) {
+        case BIT_CONST_0: return "0";
+        case BIT_CONST_1: return "1";
+        case BIT_CONST_X: return "x";
+        case BIT_CONST_Z: return "z";
+        default: return std::to_string(b);
+    }
+}
+
+
 std::string Port::to_string() const {
-    std::string msg{"{port name = " + _name + "\n"};
+    std::string msg{"{port name = " + std::string(_name) + "\n"};
       msg += "direction: " + port_dir_to_string(_direction) + "\n";
       msg += "bits: ";
       for (auto& bit: _bits) {
-        msg += std::holds_alternative<std::string>(bit) ? std::get<std::string>(bit) : std::to_string(std::get<std::size_t>(bit));
+        msg += bit_to_string(bit);
         msg += " ";
       }
       msg += "\n}\n";
@@ -33,19 +54,21 @@ std::string Port::to_string() const {
 }
 
 
-std::string Cell::to_string() const {
-    std::string msg{"{cell name = " + _name + "\n"};
+std::string Cell::to_string(const Module& owner) const {
+    std::string msg{"{cell name = " + std::string(_name) + "\n"};
     msg += "hide_name: " + (_hide ? std::to_string(1) : std::to_string(0)) + "\n";
-    msg += "type: " + _type + "\n";
+    msg += "type: " + std::string(_type) + "\n";
     msg += "port direction: \n";
-    for (auto& [name, port]: _ports) {
-    msg += "    " + name + ": " + port_dir_to_string(port->_direction) + "\n";
+    for (auto id: pins()) {
+    const auto& port = owner.pin(id);
+    msg += "    " + std::string(port._name) + ": " + port_dir_to_string(port._direction) + "\n";
     }
     msg += "connections: \n";
-    for (auto& [name, port]: _ports) {
-        msg += "    " + name + ": ";
-        for (auto bit: port->_bits) {
-            msg += (std::holds_alternative<std::string>(bit) ? std::get<std::string>(bit) : std::to_string(std::get<std::size_t>(bit)));
+    for (auto id: pins()) {
+        const auto& port = owner.pin(id);
+        msg += "    " + std::string(port._name) + ": ";
+        for (auto bit: port._bits) {
+            msg += bit_to_string(bit);
             msg += " ";
         }
         msg += "\n";
@@ -56,13 +79,22 @@ std::string Cell::to_string() const {
 }
 
 
+auto Module::add_pin(Port port) -> PortId {
+    if (this->_pins.size() >= std::numeric_limits<PortId>::max()) {
+        throw std::runtime_error("too many ports in module " + this->_name);
+    }
+    this->_pins.emplace_back(std::move(port));
+    return static_cast<PortId>(this->_pins.size() - 1);
+}
+
+
 std::string Module::to_string() const {
     std::string msg{"module name = " + _name + "\n"};
-    for (auto& [name, port]: _ports) {
-        msg += port->to_string();
+    for (auto id: _ports) {
+        msg += pin(id).to_string();
     }
-    for (auto& [name, cell]: _cells) {
-        msg += cell->to_string();
+    for (auto& cell: _cells) {
+        msg += cell.to_string(*this);
     }
     msg += "\n";
 
@@ -75,42 +107,45 @@ std::string Module::to_string() const {
 */
 
 
-Vertex::Vertex(std::string name, std::size_t v_id, const std::shared_ptr<Cell>& cell)
-    : _name{name}, _weight(1.0), _v_id(v_id), _cell(cell)
+Vertex::Vertex(std::size_t v_id, const Module& module, CellId cell)
+    : _name{}, _weight(1.0), _v_id(v_id), _module(&module), _cell(cell)
 {
-    if (cell == nullptr) {
-        throw std::runtime_error("Initialize a vertex with null cell pointer");
+    if (static_cast<std::size_t>(cell) >= module._cells.size()) {
+        throw std::runtime_error("Initialize a vertex with invalid cell handle");
     }
 
-    for (const auto& [name, port]: cell->_ports) {
-        this->_port_info.emplace(port->_name, port);
-    }
+    this->_first_pin = module.cell(cell)._first_pin;
+    this->_pin_count = module.cell(cell)._pin_count;
 }
 
-Vertex::Vertex(std::string name, std::size_t v_id, const std::shared_ptr<Port>& port)
-    : _name{name}, _weight(1.0), _v_id(v_id), _cell(nullptr)
+Vertex::Vertex(std::size_t v_id, const Module& module, PortId port)
+    : _name{}, _weight(1.0), _v_id(v_id), _module(&module), _cell(NO_CELL), _first_pin(port), _pin_count(1)
 {
-    if (port == nullptr) {
-        throw std::runtime_error("Initialize a vertex with null port pointer");
+    if (port >= module._pins.size()) {
+        throw std::runtime_error("Initialize a vertex with invalid port handle");
     }
+}
 
-    this->_port_info.emplace(port->_name, port);
+auto Vertex::name() const -> std::string_view {
+    if (!this->_name.empty()) return this->_name;
+    return this->is_cell() ? this->_module->cell(this->_cell)._name : this->_module->pin(this->_first_pin)._name;
 }
 
 std::string Vertex::to_string() const {
-    std::string msg{"{vertex id: " + std::to_string(this->_v_id) + ", name: " + this->_name + "\n"};
+    std::string msg{"{vertex id: " + std::to_string(this->_v_id) + ", name: " + std::string(this->name()) + "\n"};
     msg += "weight: " + std::to_string(this->_weight) + "\n";
-    if (this->_cell) {
+    if (this->is_cell()) {
         msg += "type: a cell\n";
     }
     else {
         msg += "type: a module port\n";
     }
     msg += "port info: \n";
-    for (auto& [name, port]: this->_port_info) {
-        msg += "    " + name + ": " + port_dir_to_string(port->_direction) + ", bit_vector ";
-        for (auto& bit: port->_bits) {
-            msg += std::holds_alternative<std::string>(bit) ? std::get<std::string>(bit) : std::to_string(std::get<std::size_t>(bit));
+    for (auto id: this->pins()) {
+        const auto& port = this->_module->pin(id);
+        msg += "    " + std::string(port._name) + ": " + port_dir_to_string(port._direction) + ", bit_vector ";
+        for (auto& bit: port._bits) {
+            msg += bit_to_string(bit);
             msg += " ";
         }
         msg += "\n";
@@ -120,250 +155,210 @@ std::string Vertex::to_string() const {
 }
 
 
-Edge::Edge(std::size_t e_id, const std::map<std::size_t, std::set<std::shared_ptr<Port>>>& port_info)
-    : _e_id(e_id), _port_info(port_info)
-{
-    std::size_t min_bitwidth {0};
-    for (auto& [v_id, ports]: this->_port_info) {
-        for (auto& port: ports) {
-            if (min_bitwidth == 0) {
-                min_bitwidth = port->_bits.size();
-            }
-            else {
-                min_bitwidth = std::min(min_bitwidth, port->_bits.size());
-            }
-        }
-    }
-    this->_weight = min_bitwidth;
-}
+HyperGraph::HyperGraph(const Module& module, std::vector<Vertex> vertices, NetRows nets) {
+    constexpr auto npos = static_cast<std::size_t>(-1);
+    constexpr auto boundary_tag = ~(npos >> 1);
 
-auto Edge::vertices() const -> std::vector<std::size_t> {
-    std::vector<std::size_t> vertices;
-    for (auto& [v_id, ports]: this->_port_info) {
-        vertices.emplace_back(v_id);
+    std::unordered_map<PortId, std::size_t> port_index{};      // PortId -> k in Module::_ports
+    for (std::size_t k = 0; k < module._ports.size(); ++k) {
+        port_index.emplace(module._ports[k], k);
     }
-    return vertices;
-}
 
-auto Edge::ports() const -> std::vector<std::shared_ptr<Port>> {
-    std::vector<std::shared_ptr<Port>> connected_ports;
-    for (auto& [v_id, ports]: this->_port_info) {
-        connected_ports.insert(connected_ports.end(), ports.begin(), ports.end());
+    // vertices are consumed in place: module ports are dropped and cells slide down to
+    // their new id in one pass, so no second copy of the vertex list is made
+    const auto by_vid = [](const Vertex& a, const Vertex& b) { return a.v_id() < b.v_id(); };
+    if (!std::is_sorted(vertices.begin(), vertices.end(), by_vid)) {
+        std::sort(vertices.begin(), vertices.end(), by_vid);
     }
-    return connected_ports;
-}
-
-
-std::string Edge::to_string() const {
-    std::string msg{"{edge id = " + std::to_string(this->_e_id) + "\n"};
-    msg += "weight: " + std::to_string(this->_weight) + "\n";
-    msg += "port info: \n";
-    for (auto& [v_id, ports]: this->_port_info) {
-        for (auto& port: ports) {
-            msg += "    vertex: " + std::to_string(v_id) + ", " + port->_name + ": " + port_dir_to_string(port->_direction) + ", bit_vector ";
-            for (auto& bit: port->_bits) {
-                msg += std::holds_alternative<std::string>(bit) ? std::get<std::string>(bit) : std::to_string(std::get<std::size_t>(bit));
-                msg += " ";
+    std::vector<std::size_t> old_vids(vertices.size());
+    std::vector<std::size_t> new_vids(vertices.size());
+    std::vector<std::size_t> port_ks(vertices.size(), npos);
+    std::size_t kept{0};
+    this->_v_weights.reserve(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        old_vids[i] = vertices[i].v_id();
+        if (i > 0 && old_vids[i] == old_vids[i - 1]) {
+            throw std::logic_error("duplicate vertex id " + std::to_string(old_vids[i]) + " in hypergraph");
+        }
+        if (!vertices[i].is_cell()) {
+            if (vertices[i].pins().size() != 1) {
+                throw std::logic_error("module port should have only one port");
+            }
+            new_vids[i] = npos;
+            if (const auto it = port_index.find(vertices[i].pins().front()); it != port_index.end()) {
+                port_ks[i] = it->second;
             }
-            msg += "\n";
+            continue;
         }
-    }
-    msg += "\n}\n";
-    return msg;
-}
-
-void Edge::remove_port_in_edge(std::size_t v_id, std::shared_ptr<Port>& port) {
-    if (this->_port_info.find(v_id) == this->_port_info.end()) {
-        return;
-    }
-    auto& ports = this->_port_info.at(v_id);
-    if (ports.find(port) == ports.end()) {
-        return;
-    }
-    global::log_debug("found port " + port->_name + " in vertex " + std::to_string(v_id) + " in edge " + std::to_string(this->_e_id));
-    ports.erase(port);
-}
-
-void Edge::add_port_in_edge(std::size_t v_id, std::shared_ptr<Port>& port) {
-    if (this->_port_info.find(v_id) == this->_port_info.end()) {
-        this->_port_info.emplace(v_id, std::set<std::shared_ptr<Port>>{});
-    }
-    this->_port_info.at(v_id).emplace(port);
-}
-
-void HyperGraph::remove_port_in_edge(std::size_t e_id, std::size_t v_id, std::shared_ptr<Port>& port) {
-    if (this->_edges.find(e_id) == this->_edges.end()) {
-        global::log_info("Edge " + std::to_string(e_id) + " not found in hypergraph");
-        return;
-    }
-    auto& edge = this->_edges.at(e_id);
-    edge.remove_port_in_edge(v_id, port);
-}
-
-void HyperGraph::add_port_in_edge(std::size_t e_id, std::size_t v_id, std::shared_ptr<Port>& port) {
-    const auto& iter = this->_edges.find(e_id);
-    if (iter != this->_edges.end()) {
-        const auto& v_port = iter->second.v_port();
-        auto port_iter = v_port.find(v_id);
-        if (port_iter == v_port.end() && port_iter->second.find(port) != port_iter->second.end()) {
-            global::log_info("Port " + port->_name + " already connected to vertex " + std::to_string(v_id) + " in edge " + std::to_string(e_id));
-            return;
+        new_vids[i] = kept;
+        if (i != kept) {
+            vertices[kept] = std::move(vertices[i]);
         }
+        vertices[kept].set_vid(kept);
+        this->_v_weights.emplace_back(static_cast<std::int64_t>(vertices[kept].weight()));
+        ++kept;
+    }
+    vertices.erase(vertices.begin() + static_cast<std::ptrdiff_t>(kept), vertices.end());
+    this->_vertices = std::move(vertices);
+
+    // old ids are sorted and unique; when they are 0..n-1 (as modue2hgraph hands them out) no search is needed
+    const bool dense = old_vids.empty() || old_vids.back() == old_vids.size() - 1;
+    const auto position = [&](std::size_t old) -> std::size_t {
+        if (dense) return old < old_vids.size() ? old : npos;
+        const auto it = std::lower_bound(old_vids.begin(), old_vids.end(), old);
+        return it != old_vids.end() && *it == old ? static_cast<std::size_t>(it - old_vids.begin()) : npos;
+    };
+
+    // edge -> vertex rows, in net order; old v_ids map monotonically, so rows stay sorted.
+    // the rows of one vertex on a net become one pin, their ports that pin's ports
+    this->_e_offsets.reserve(nets.size() + 1);
+    this->_e_weights.reserve(nets.size());
+    this->_e_offsets.emplace_back(0);
+    this->_pin_port_offsets.emplace_back(0);
+    std::vector<std::pair<std::size_t, std::size_t>> port_hits;     // (k, edge id or boundary_tag | j)
+    std::vector<std::size_t> edge_ks;
+    for (std::size_t e = 0; e < nets.size(); ++e) {
+        edge_ks.clear();
+        std::size_t bitwidth{0};                                    // narrowest port on the net
+        for (auto r = nets.offsets[e]; r < nets.offsets[e + 1];) {
+            const auto v_id = nets.vertices[r];
+            auto last = r;
+            for (; last < nets.offsets[e + 1] && nets.vertices[last] == v_id; ++last) {
+                const auto width = module.pin(nets.ports[last])._bits.size();
+                bitwidth = bitwidth == 0 ? width : std::min(bitwidth, width);
+            }
+            const auto first = std::exchange(r, last);
+            const auto pos = position(v_id);
+            if (pos == npos) {
+                continue;
+            }
+            if (new_vids[pos] == npos) {
+                for (auto i = first; i < last; ++i) {
+                    global::log_debug("found port " + std::string(module.pin(nets.ports[i])._name) + " in vertex " + std::to_string(v_id) + " in edge " + std::to_string(e));
+                }
+                if (port_ks[pos] != npos) edge_ks.emplace_back(port_ks[pos]);
+                continue;
+            }
+            this->_e_pins.emplace_back(new_vids[pos]);
+            this->_pin_ports.insert(this->_pin_ports.end(), nets.ports.begin() + first, nets.ports.begin() + last);
+            this->_pin_port_offsets.emplace_back(this->_pin_ports.size());
+        }
+        std::size_t net{};
+        if (this->_e_pins.size() == this->_e_offsets.back()) {
+            if (edge_ks.empty()) continue;
+            net = boundary_tag | this->_b_weights.size();      // only module ports on this edge
+            this->_b_weights.emplace_back(static_cast<std::int64_t>(bitwidth));
+        } else {
+            net = this->num_edges();
+            this->_e_offsets.emplace_back(this->_e_pins.size());
+            this->_e_weights.emplace_back(static_cast<std::int64_t>(bitwidth));
+        }
+        for (auto k: edge_ks) port_hits.emplace_back(k, net);
     }
+    nets = NetRows{};
 
-    auto& edge = iter->second;
-    edge.add_port_in_edge(v_id, port);
-}
-
-auto HyperGraph::remove_edge(std::size_t e_id) -> void {
-    if (this->_edges.find(e_id) == this->_edges.end()) {
-        global::log_info("Edge " + std::to_string(e_id) + " not found in hypergraph");
-        return;
-    }
-    this->_edges.erase(e_id);
-}
-
-void HyperGraph::remove_vertex(std::size_t v_id) {
-    if (this->_vertices.find(v_id) == this->_vertices.end()) {
-        global::log_info("Vertex " + std::to_string(v_id) + " not found in hypergraph");
-        return;
+    // boundary rows; boundary nets are numbered after the last edge
+    this->_port_offsets.assign(module._ports.size() + 1, 0);
+    for (const auto& [k, net]: port_hits) {
+        ++this->_port_offsets[k + 1];
     }
-    this->_vertices.erase(v_id);
-    this->_v2e.erase(v_id);
-}
-
-void HyperGraph::remove_edge_in_v2e(std::size_t v_id, std::size_t e_id) {
-    if (this->_v2e.find(v_id) == this->_v2e.end()) {
-        global::log_info("Vertex " + std::to_string(v_id) + " not found in hypergraph");
-        return;
+    for (std::size_t k = 0; k < module._ports.size(); ++k) {
+        this->_port_offsets[k + 1] += this->_port_offsets[k];
     }
-    auto& edges = this->_v2e.at(v_id);
-    edges.erase(std::remove(edges.begin(), edges.end(), e_id), edges.end());
-}
-
-void HyperGraph::remove_all_edge_in_v2e(std::size_t v_id) {
-    if (this->_v2e.find(v_id) == this->_v2e.end()) {
-        global::log_info("Vertex " + std::to_string(v_id) + " not found in hypergraph");
-        return;
+    this->_port_nets.resize(port_hits.size());
+    std::vector<std::size_t> port_fill(this->_port_offsets.begin(), this->_port_offsets.end() - 1);
+    for (const auto& [k, net]: port_hits) {
+        this->_port_nets[port_fill[k]++] = (net & boundary_tag) ? this->num_edges() + (net & ~boundary_tag) : net;
     }
-    this->_v2e.at(v_id).clear();
-    this->_v2e.erase(v_id);
-}
 
-void HyperGraph::add_edge_in_v2e(std::size_t v_id, std::size_t e_id) {
-    if (this->_v2e.find(v_id) == this->_v2e.end()) {
-        global::log_info("Vertex " + std::to_string(v_id) + " not found in hypergraph");
-        return;
-    }
-    auto& edges = this->_v2e.at(v_id);
-    edges.emplace_back(e_id);
-}
+    this->build_incidence();
 
-HyperGraph::HyperGraph(const std::vector<Vertex>& vertices, const std::vector<Edge>& edges) {
-    // get vertices & edges
-    for (const auto& vertex: vertices) {
-        this->_vertices.emplace(vertex.v_id(), vertex);
+    std::size_t isolated{0};
+    for (std::size_t v = 0; v < this->_vertices.size(); ++v) {
+        if (this->_v_offsets[v] == this->_v_offsets[v + 1]) ++isolated;
     }
-    for (auto& edge: edges) {
-        this->_edges.emplace(edge.e_id(), edge);
+    if (isolated > 0) {
+        global::log_debug("Existing " + std::to_string(isolated) + " vertices not included in edges!");
+        throw std::logic_error("unexpected logic exception during creating hypergraph");
     }
+}
 
-    std::map<std::size_t, std::shared_ptr<Port>> module_port{};
-    std::unordered_map<std::size_t, std::size_t> old2new_vid{};
-    for (auto& [v_id, vertex]: this->_vertices) {
-        if (vertex.cell() == nullptr) {
-            auto port = vertex.port_info();
-            if (port.size() > 1) {
-                throw std::logic_error("module port should have only one port");
-            }
-            module_port.emplace(v_id, port.begin()->second);
-        }
-    }
-    for (auto& [v_id, port]: module_port) {
-        this->_vertices.erase(v_id);
-    }
 
-    std::vector<std::size_t> old_ids;
-    old_ids.reserve(this->_vertices.size());
-    for (const auto& kv : this->_vertices) old_ids.emplace_back(kv.first);
-    std::sort(old_ids.begin(), old_ids.end());
-
-    std::unordered_map<std::size_t, Vertex> new_vertices{};
-    std::size_t new_vid{0};
-    for (auto old_id : old_ids) {
-        auto vertex = this->_vertices.at(old_id);
-        vertex.set_vid(new_vid);
-        old2new_vid.emplace(old_id, new_vid);
-        new_vertices.emplace(new_vid, vertex);
-        ++new_vid;
+// vertex -> edge rows by counting sort; edges are visited in id order, so rows stay sorted
+auto HyperGraph::build_incidence() -> void {
+    this->_v_offsets.assign(this->_vertices.size() + 1, 0);
+    for (auto v_id: this->_e_pins) {
+        ++this->_v_offsets[v_id + 1];
     }
-    this->_vertices = std::move(new_vertices);
-
-    for (auto& [e_id, edge] : this->_edges) {
-        for (auto& [v_id, port] : module_port) {
-            edge.remove_port_in_edge(v_id, port);
-        }
-        std::map<std::size_t, std::set<std::shared_ptr<Port>>> updated;
-        for (auto& [v_id, ports] : edge.v_port()) {
-            auto it = old2new_vid.find(v_id);
-            if (it != old2new_vid.end()) {
-                updated.emplace(it->second, ports);
-            }
-        }
-        edge.set_port_info(updated);
+    for (std::size_t v = 0; v < this->_vertices.size(); ++v) {
+        this->_v_offsets[v + 1] += this->_v_offsets[v];
     }
-
-    // create v2e
-    for (auto& edge: this->_edges) {
-        for (auto& v_id: edge.second.vertices()) {
-            auto iter = this->_v2e.emplace(v_id, std::vector<std::size_t>{});
-            iter.first->second.emplace_back(edge.second.e_id());
+    this->_v_edges.resize(this->_e_pins.size());
+    std::vector<std::size_t> fill(this->_v_offsets.begin(), this->_v_offsets.end() - 1);
+    for (std::size_t e = 0; e < this->num_edges(); ++e) {
+        for (auto v_id: this->pins(e)) {
+            this->_v_edges[fill[v_id]++] = e;
         }
     }
-
-    if(this->_v2e.size() < this->_vertices.size()) {
-        auto diff = this->_vertices.size() - this->_v2e.size();
-        global::log_debug("Existing " + std::to_string(diff) + " vertices not included in edges!");
-        this->to_string();
-        throw std::logic_error("unexpected logic exception during creating hypergraph");
-    }
 }
 
 
 std::string HyperGraph::to_string() const {
-    std::string msg{std::to_string(this->_vertices.size()) + " hypergraph vertices: \n"};
-    for (auto& [v_id, vertex]: this->_vertices) {
+    std::string msg{std::to_string(this->num_vertices()) + " hypergraph vertices: \n"};
+    for (auto& vertex: this->_vertices) {
         msg += vertex.to_string();
     }
-    msg += std::to_string(this->_edges.size()) + " hypergraph edges: \n";
-    for (auto& [e_id, edge]: this->_edges) {
-        msg += edge.to_string();
+    msg += std::to_string(this->num_edges()) + " hypergraph edges: \n";
+    for (std::size_t e = 0; e < this->num_edges(); ++e) {
+        msg += "{edge id = " + std::to_string(e) + "\n";
+        msg += "weight: " + std::to_string(this->_e_weights[e]) + "\n";
+        msg += "port info: \n";
+        for (auto p = this->_e_offsets[e]; p < this->_e_offsets[e + 1]; ++p) {
+            const auto& owner = this->_vertices[this->_e_pins[p]].module();
+            for (auto id: this->pin_ports(p)) {
+                const auto& port = owner.pin(id);
+                msg += "    vertex: " + std::to_string(this->_e_pins[p]) + ", " + std::string(port._name) + ": " + port_dir_to_string(port._direction) + ", bit_vector ";
+                for (auto& bit: port._bits) {
+                    msg += bit_to_string(bit);
+                    msg += " ";
+                }
+                msg += "\n";
+            }
+        }
+        msg += "\n}\n";
     }
 
     return msg;
 }
 
-auto HyperGraph::v2e() const -> const std::unordered_map<std::size_t, std::vector<std::size_t>>& {
-    return this->_v2e;
-}
-
-auto HyperGraph::vertex_weight(std::size_t v_id) const -> double {
-    const auto it = this->_vertices.find(v_id);
-    if (it == this->_vertices.end()) throw std::out_of_range("vertex not found");
-    return it->second.weight();
-}
-
-auto HyperGraph::edge_weight(std::size_t e_id) const -> double {
-    const auto it = this->_edges.find(e_id);
-    if (it == this->_edges.end()) throw std::out_of_range("edge not found");
-    return it->second.weight();
+auto HyperGraph::cut(const std::vector<std::size_t>& part) const -> std::int64_t {
+    std::int64_t total{0};
+    for (std::size_t e = 0; e < this->num_edges(); ++e) {
+        const auto row = this->pins(e);
+        const auto first = part[row.front()];
+        for (auto v_id: row.subspan(1)) {
+            if (part[v_id] != first) {
+                total += this->_e_weights[e];
+                break;
+            }
+        }
+    }
+    return total;
 }
 
-auto HyperGraph::vertex_name(std::size_t v_id) const -> std::string {
-    const auto it = this->_vertices.find(v_id);
-    if (it == this->_vertices.end()) throw std::out_of_range("vertex not found");
-    return it->second.name();
+auto HyperGraph::km1(const std::vector<std::size_t>& part) const -> std::int64_t {
+    std::int64_t total{0};
+    std::vector<std::size_t> blocks;
+    for (std::size_t e = 0; e < this->num_edges(); ++e) {
+        blocks.clear();
+        for (auto v_id: this->pins(e)) {
+            blocks.emplace_back(part[v_id]);
+        }
+        std::sort(blocks.begin(), blocks.end());
+        const auto lambda = std::unique(blocks.begin(), blocks.end()) - blocks.begin();
+        total += (lambda - 1) * this->_e_weights[e];
+    }
+    return total;
 }
 
-
 }
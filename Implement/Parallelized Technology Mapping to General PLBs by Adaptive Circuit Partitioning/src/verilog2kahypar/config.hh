@@ -2,13 +2,14 @@
 #define CONFIG_HH
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
-#include <map>
+#include <string_view>
+#include <ranges>
 #include <unordered_map>
 #include <vector>
-#include <variant>
-#include <memory>
-#include <set>
+#include <span>
+#include <utility>
 
 
 namespace parser {
@@ -17,6 +18,9 @@ namespace parser {
 ************************** Json file info **************************
 */
 
+// Cell and port names (and cell types) are views into the JSON input held by the
+// Reader that built the Module, so a Module must not outlive its Reader.
+
 enum class PortDirection {
     INPUT,
     OUTPUT,
@@ -25,32 +29,93 @@ enum class PortDirection {
 
 std::string port_dir_to_string(PortDirection direction);
 
+// A port bit packed into 32 bits: Yosys signal ids are stored as they are, the constants
+// '0', '1', 'x' and 'z' take the four values at the top of the range. Signals sort before
+// constants and '0' < '1' < 'x' < 'z', the same order the old variant<size_t, string> had.
+using Bit = std::uint32_t;
+using BitVector = std::vector<Bit>;
+
+inline constexpr Bit BIT_CONST_0 = 0xFFFFFFFCu;
+inline constexpr Bit BIT_CONST_1 = 0xFFFFFFFDu;
+inline constexpr Bit BIT_CONST_X = 0xFFFFFFFEu;
+inline constexpr Bit BIT_CONST_Z = 0xFFFFFFFFu;
+
+inline constexpr auto is_const_bit(Bit b) -> bool { return b >= BIT_CONST_0; }
+auto const_bit(std::string_view value) -> Bit;
+auto bit_to_string(Bit b) -> std::string;
+
+// word-wise hash over four independent lanes, so the loop vectorizes
+struct BitVectorHash {
+    auto operator()(const BitVector& bits) const noexcept -> std::size_t {
+        constexpr std::uint64_t prime = 0x100000001B3ull;
+        std::uint64_t lane[4] = {0xCBF29CE484222325ull, 0x84222325CBF29CE4ull, 0x9E3779B97F4A7C15ull, 0x7F4A7C159E3779B9ull};
+        const std::size_t n = bits.size();
+        std::size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            for (std::size_t k = 0; k < 4; ++k) lane[k] = (lane[k] ^ bits[i + k]) * prime;
+        }
+        for (; i < n; ++i) lane[0] = (lane[0] ^ bits[i]) * prime;
+        return static_cast<std::size_t>((lane[0] ^ (lane[1] >> 1)) + (lane[2] ^ (lane[3] << 1)) + n);
+    }
+};
+
+// Handles into the arenas of a Module. They stay valid for the lifetime of the Module,
+// also when it is copied or moved, unlike pointers to its elements.
+// CellId is a distinct type, so the two cannot be mixed up.
+using PortId = std::uint32_t;
+enum class CellId : std::uint32_t {};
+
+inline constexpr CellId NO_CELL = static_cast<CellId>(-1);
+
+struct Module;
+
 struct Port {
-    std::string _name;
+    std::string_view _name;
     PortDirection _direction;
-    std::vector<std::variant<std::size_t, std::string>> _bits;
+    BitVector _bits;
 
     std::string to_string() const;
 };
 
 
+// a cell parameter, the value kept as its JSON text ("0101", "text " or a number)
+struct Param {
+    std::string_view _name;
+    std::string_view _value;
+};
+
+
 struct Cell {
-    std::string _name;
+    std::string_view _name;
     bool _hide;
-    std::string _type;
-    std::map<std::string, std::shared_ptr<Port>> _ports;        // port_name, Port*
-
-    std::string to_string() const;
+    std::string_view _type;
+    PortId _first_pin;                  // pins of the cell are _pins[_first_pin, _first_pin + _pin_count),
+    std::uint32_t _pin_count;           // sorted by name
+    std::uint32_t _first_param;         // parameters are _params[_first_param, _first_param + _param_count),
+    std::uint32_t _param_count;         // in file order
+
+    auto pins() const -> std::ranges::iota_view<PortId, PortId> {
+        return std::views::iota(_first_pin, _first_pin + _pin_count);
+    }
+    std::string to_string(const Module& owner) const;
 };
 
 
+// Netlist of one module. Module ports and cell pins live in one flat arena and are
+// addressed by PortId; cells are stored by value, sorted by name.
 struct Module {
     std::string _name;
-    std::map<std::string, std::shared_ptr<Port>> _ports;
-    std::map<std::string, std::shared_ptr<Cell>> _cells;
+    std::vector<Port> _pins;            // module ports and cell pins
+    std::vector<Cell> _cells;           // sorted by name
+    std::vector<PortId> _ports;         // module ports, sorted by name
+    std::vector<Param> _params;         // cell parameters
 
     // 加一个数据结构，描述每个 module 的层次，以及每个 module 包含了哪些 cell
 
+    auto pin(PortId id) const -> const Port& {return this->_pins[id];}
+    auto cell(CellId id) const -> const Cell& {return this->_cells[static_cast<std::size_t>(id)];}
+    auto add_pin(Port port) -> PortId;
+
     std::string to_string() const;
 };
 
@@ -61,82 +126,132 @@ struct Module {
 
 class Vertex {
 public:
-    Vertex(std::string, std::size_t, const std::shared_ptr<Cell>&);
-    Vertex(std::string, std::size_t, const std::shared_ptr<Port>&);
+    Vertex(std::size_t, const Module&, CellId);     // a cell with all its pins
+    Vertex(std::size_t, const Module&, PortId);     // a module port
     ~Vertex() = default;
+    Vertex(const Vertex&) = default;
+    Vertex(Vertex&&) noexcept = default;
+    auto operator=(const Vertex&) -> Vertex& = default;
+    auto operator=(Vertex&&) noexcept -> Vertex& = default;
 
 public:
     auto set_vid(std::size_t vid) -> void {this->_v_id = vid;}
+    auto set_name(std::string name) -> void {this->_name = std::move(name);}
 
 public:
-    auto name() const -> std::string {return this->_name;}
+    auto name() const -> std::string_view;              // the cell or port name, unless renamed
     auto weight() const -> double {return this->_weight;}
     auto v_id() const -> std::size_t {return this->_v_id;}
-    auto cell() const -> std::shared_ptr<Cell> {return this->_cell;}
+    auto cell() const -> CellId {return this->_cell;}
+    auto is_cell() const -> bool {return this->_cell != NO_CELL;}
+    auto module() const -> const Module& {return *this->_module;}
     auto to_string() const -> std::string;
-    auto port_info() const -> std::map<std::string, std::shared_ptr<Port>> {return this->_port_info;}
+    auto pins() const -> std::ranges::iota_view<PortId, PortId> {
+        return std::views::iota(this->_first_pin, this->_first_pin + this->_pin_count);
+    }
 
 private:
-    std::string _name;
+    std::string _name;              // empty: the name of the cell or port, which the module holds
     double _weight;
     std::size_t _v_id;
-    std::shared_ptr<Cell> _cell;    // if nullptr, then vertex is a port
-    std::map<std::string, std::shared_ptr<Port>> _port_info;
+    const Module* _module;
+    CellId _cell;                   // if NO_CELL, then vertex is a port
+    PortId _first_pin;
+    std::uint32_t _pin_count;
 };
 
 
-class Edge {
-public:
-    Edge(std::size_t, const std::map<std::size_t, std::set<std::shared_ptr<Port>>>&);
-    ~Edge() = default;
-
-public:
-    auto set_port_info(const std::map<std::size_t, std::set<std::shared_ptr<Port>>>& port_info) -> void {this->_port_info = port_info;}
-
-public:
-    auto weight() const -> double {return this->_weight;} 
-    auto e_id() const -> std::size_t {return this->_e_id;}
-    auto v_port() const -> std::map<std::size_t, std::set<std::shared_ptr<Port>>> {return this->_port_info;}
-    auto to_string() const -> std::string;
-    auto vertices() const -> std::vector<std::size_t>;
-    auto ports() const -> std::vector<std::shared_ptr<Port>>;
+// Nets of one module as flat (vertex, port) rows, the input HyperGraph is built from:
+//   rows of net e:          vertices / ports [offsets[e] .. offsets[e + 1]), ordered by
+//                           vertex, then port
+// The HyperGraph constructor weighs each net by the narrowest of its ports.
+struct NetRows {
+    std::vector<std::size_t> offsets{0};
+    std::vector<std::size_t> vertices;
+    std::vector<PortId> ports;
 
-    auto remove_port_in_edge(std::size_t v_id, std::shared_ptr<Port>& port) -> void;
-    auto add_port_in_edge(std::size_t v_id, std::shared_ptr<Port>& port) -> void;
-
-private:
-    std::size_t _e_id;
-    double _weight;                                             // maximum bitwidth on connections
-    std::map<std::size_t, std::set<std::shared_ptr<Port>>> _port_info;    // ports in this edge, not all the ports in vertex
+    auto size() const -> std::size_t {return this->offsets.size() - 1;}
 };
 
 
+// Hypergraph of one module in compressed sparse row form, built once and read-only after.
+// Module ports are stripped, the remaining vertices keep their relative order and are
+// numbered 0..n-1; edges left without pins are dropped and the rest renumbered the same way.
+//   pins of edge e:         _e_pins[_e_offsets[e] .. _e_offsets[e + 1]), ascending
+//   edges of vertex v:      _v_edges[_v_offsets[v] .. _v_offsets[v + 1]), ascending
+//   ports behind pin p:     _pin_ports[_pin_port_offsets[p] .. _pin_port_offsets[p + 1]),
+//                           p indexing _e_pins
+// The stripped module ports are kept as the boundary, which is what instances of the
+// module are stitched through when the hierarchy is flattened:
+//   nets on module port k:  _port_nets[_port_offsets[k] .. _port_offsets[k + 1]), k indexing
+//                           Module::_ports. Ids from num_edges() on are boundary nets, edges
+//                           that joined module ports only; they have no pins and are not exported.
 class HyperGraph {
+    friend class Flattener;
+
 public:
-    HyperGraph(const std::vector<Vertex>&, const std::vector<Edge>&);
+    HyperGraph(const Module&, std::vector<Vertex>, NetRows);               // consumes its inputs
     ~HyperGraph() = default;
+    HyperGraph(const HyperGraph&) = default;
+    HyperGraph(HyperGraph&&) noexcept = default;
+    auto operator=(const HyperGraph&) -> HyperGraph& = default;
+    auto operator=(HyperGraph&&) noexcept -> HyperGraph& = default;
 
 public:
     auto to_string() const -> std::string;
-    auto vertices() const -> const std::vector<Vertex>&;
-    auto edges() const -> const std::vector<Edge>&;
-    auto v2e() const -> const std::unordered_map<std::size_t, std::vector<std::size_t>>&;
-    auto vertex_weight(std::size_t v_id) const -> double;
-    auto edge_weight(std::size_t e_id) const -> double;
-    auto vertex_name(std::size_t v_id) const -> std::string;
-
-    auto remove_port_in_edge(std::size_t e_id, std::size_t v_id, std::shared_ptr<Port>& port) -> void;
-    auto add_port_in_edge(std::size_t e_id, std::size_t v_id, std::shared_ptr<Port>& port) -> void;
-    auto remove_edge(std::size_t e_id) -> void;
-    auto remove_vertex(std::size_t v_id) -> void;
-    auto remove_edge_in_v2e(std::size_t v_id, std::size_t e_id) -> void;
-    auto remove_all_edge_in_v2e(std::size_t v_id) -> void;
-    auto add_edge_in_v2e(std::size_t v_id, std::size_t e_id) -> void;
-    
+    auto num_vertices() const -> std::size_t {return this->_vertices.size();}
+    auto num_edges() const -> std::size_t {return this->_e_weights.size();}
+    auto num_pins() const -> std::size_t {return this->_e_pins.size();}
+    auto vertices() const -> const std::vector<Vertex>& {return this->_vertices;}
+    auto pins(std::size_t e_id) const -> std::span<const std::size_t> {
+        return {this->_e_pins.data() + this->_e_offsets[e_id], this->_e_offsets[e_id + 1] - this->_e_offsets[e_id]};
+    }
+    auto incident_edges(std::size_t v_id) const -> std::span<const std::size_t> {
+        return {this->_v_edges.data() + this->_v_offsets[v_id], this->_v_offsets[v_id + 1] - this->_v_offsets[v_id]};
+    }
+    auto pin_begin(std::size_t e_id) const -> std::size_t {return this->_e_offsets[e_id];}
+    auto pin_ports(std::size_t pin) const -> std::span<const PortId> {
+        return {this->_pin_ports.data() + this->_pin_port_offsets[pin], this->_pin_port_offsets[pin + 1] - this->_pin_port_offsets[pin]};
+    }
+    auto vertex_weight(std::size_t v_id) const -> std::int64_t {return this->_v_weights[v_id];}
+    auto edge_weight(std::size_t e_id) const -> std::int64_t {return this->_e_weights[e_id];}
+    auto vertex_name(std::size_t v_id) const -> std::string_view {return this->_vertices[v_id].name();}
+    // the raw CSR arrays, for writers that dump the whole graph
+    auto edge_offsets() const -> std::span<const std::size_t> {return this->_e_offsets;}
+    auto edge_pins() const -> std::span<const std::size_t> {return this->_e_pins;}
+    auto edge_weights() const -> std::span<const std::int64_t> {return this->_e_weights;}
+    auto vertex_weights() const -> std::span<const std::int64_t> {return this->_v_weights;}
+
+    auto num_ports() const -> std::size_t {return this->_port_offsets.size() - 1;}
+    auto num_boundary_nets() const -> std::size_t {return this->_b_weights.size();}
+    auto port_nets(std::size_t k) const -> std::span<const std::size_t> {
+        return {this->_port_nets.data() + this->_port_offsets[k], this->_port_offsets[k + 1] - this->_port_offsets[k]};
+    }
+    auto net_weight(std::size_t n) const -> std::int64_t {      // edges and boundary nets
+        return n < this->num_edges() ? this->_e_weights[n] : this->_b_weights[n - this->num_edges()];
+    }
+
+    // metrics of a partition (block id per vertex)
+    auto cut(const std::vector<std::size_t>& part) const -> std::int64_t;    // weight of edges spanning > 1 block
+    auto km1(const std::vector<std::size_t>& part) const -> std::int64_t;    // sum of (blocks spanned - 1) * weight
+
+private:
+    HyperGraph() = default;
+    auto build_incidence() -> void;                 // _v_offsets / _v_edges from the edge rows
+
 private:
-    std::unordered_map<std::size_t, Vertex> _vertices;
-    std::unordered_map<std::size_t, Edge> _edges;
-    std::unordered_map<std::size_t, std::vector<std::size_t>> _v2e;  // map vertex id to edge id
+    std::vector<Vertex> _vertices;                  // index is v_id
+    std::vector<std::int64_t> _v_weights;
+    std::vector<std::int64_t> _e_weights;
+    std::vector<std::size_t> _e_offsets;
+    std::vector<std::size_t> _e_pins;
+    std::vector<std::size_t> _v_offsets;
+    std::vector<std::size_t> _v_edges;
+    std::vector<std::size_t> _pin_port_offsets;
+    std::vector<PortId> _pin_ports;
+    std::vector<std::int64_t> _b_weights;           // boundary nets
+    std::vector<std::size_t> _port_offsets{0};
+    std::vector<std::size_t> _port_nets;
 };
 
 
@@ -0,0 +1,267 @@
+#include "flatten.hh"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "../global/debug.hh"
+
+
+namespace parser {
+
+namespace {
+
+// path-halving union-find; the smaller id becomes the root, so roots do not depend on
+// the order of the unions
+class UnionFind {
+public:
+    explicit UnionFind(std::size_t n) : _parent(n) {
+        for (std::size_t i = 0; i < n; ++i) _parent[i] = i;
+    }
+
+    auto find(std::size_t x) -> std::size_t {
+        while (_parent[x] != x) {
+            _parent[x] = _parent[_parent[x]];
+            x = _parent[x];
+        }
+        return x;
+    }
+
+    auto unite(std::size_t a, std::size_t b) -> void {
+        a = find(a);
+        b = find(b);
+        if (a == b) return;
+        if (b < a) std::swap(a, b);
+        _parent[b] = a;
+    }
+
+private:
+    std::vector<std::size_t> _parent;
+};
+
+// index of the port called `name` in Module::_ports (sorted by name), or npos
+auto port_index(const Module& mod, std::string_view name) -> std::size_t {
+    const auto it = std::lower_bound(mod._ports.begin(), mod._ports.end(), name,
+        [&](PortId id, std::string_view n) { return mod.pin(id)._name < n; });
+    if (it == mod._ports.end() || mod.pin(*it)._name != name) {
+        return static_cast<std::size_t>(-1);
+    }
+    return static_cast<std::size_t>(it - mod._ports.begin());
+}
+
+}
+
+
+Flattener::Flattener(
+    const std::vector<Module>& modules,
+    const std::unordered_map<std::string, HyperGraph>& graphs,
+    const std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>>& children,
+    const std::unordered_map<std::string, std::size_t>& cell_counts,
+    std::size_t max_weight
+)
+    : _graphs(graphs), _children(children), _cell_counts(cell_counts), _max_weight(max_weight)
+{
+    for (const auto& mod: modules) {
+        this->_modules.emplace(mod._name, &mod);
+    }
+}
+
+auto Flattener::flatten(const std::string& module_name) -> const HyperGraph& {
+    if (const auto it = this->_flat.find(module_name); it != this->_flat.end()) {
+        return it->second;
+    }
+    if (!this->_in_progress.insert(module_name).second) {
+        throw std::runtime_error("module " + module_name + " instantiates itself");
+    }
+
+    const auto mod = this->_modules.find(module_name);
+    const auto hg = this->_graphs.find(module_name);
+    if (mod == this->_modules.end() || hg == this->_graphs.end()) {
+        throw std::runtime_error("no hypergraph for module " + module_name);
+    }
+
+    // children first; references into _flat stay valid while it grows
+    std::unordered_map<std::string_view, Instance> instances;
+    if (const auto it = this->_children.find(module_name); it != this->_children.end()) {
+        for (const auto& [cell_name, type]: it->second) {
+            const auto count = this->_cell_counts.at(type);
+            const HyperGraph* child = nullptr;
+            if (this->_max_weight == 0 || count > this->_max_weight) {
+                child = &this->flatten(type);
+            }
+            instances.emplace(cell_name, Instance{this->_modules.at(type), child, static_cast<std::int64_t>(count)});
+        }
+    }
+
+    auto flat = instances.empty() ? hg->second : this->stamp(*mod->second, hg->second, instances);
+    global::log_debug("flattened module " + module_name + ": " + std::to_string(flat.num_vertices()) + " vertices, "
+        + std::to_string(flat.num_edges()) + " edges");
+    this->_in_progress.erase(module_name);
+    return this->_flat.emplace(module_name, std::move(flat)).first->second;
+}
+
+auto Flattener::stamp(const Module& mod, const HyperGraph& hg, const std::unordered_map<std::string_view, Instance>& instances) const
+    -> HyperGraph
+{
+    constexpr auto npos = static_cast<std::size_t>(-1);
+    const auto nv = hg.num_vertices();
+    const auto own_nets = hg.num_edges() + hg.num_boundary_nets();
+
+    // layout: vertex v of hg becomes one vertex, or the block of its instance's vertices;
+    // own nets come first, then the nets (edges and boundary nets) of each instance
+    std::vector<const Module*> child_mod(nv, nullptr);
+    std::vector<const HyperGraph*> child(nv, nullptr);
+    std::vector<std::int64_t> weight(hg._v_weights);        // super-vertices weigh their cell count
+    std::vector<std::size_t> v_base(nv + 1, 0);
+    std::vector<std::size_t> n_base(nv + 1, own_nets);
+    for (std::size_t v = 0; v < nv; ++v) {
+        if (const auto it = instances.find(hg.vertex_name(v)); it != instances.end()) {
+            child_mod[v] = it->second.mod;
+            child[v] = it->second.flat;
+            weight[v] = it->second.weight;
+        }
+        v_base[v + 1] = v_base[v] + (child[v] ? child[v]->num_vertices() : 1);
+        n_base[v + 1] = n_base[v] + (child[v] ? child[v]->num_edges() + child[v]->num_boundary_nets() : 0);
+    }
+    const auto nodes = n_base[nv];
+
+    // stitch: an own net meets the nets on the instance port it is wired to
+    UnionFind uf(nodes);
+    for (std::size_t e = 0; e < hg.num_edges(); ++e) {
+        for (auto p = hg.pin_begin(e); p < hg.pin_begin(e + 1); ++p) {
+            const auto v = hg._e_pins[p];
+            if (!child[v]) continue;
+            for (auto id: hg.pin_ports(p)) {
+                const auto k = port_index(*child_mod[v], mod.pin(id)._name);
+                if (k == npos) {
+                    global::log_info("instance " + std::string(hg.vertex_name(v)) + " has no port " + std::string(mod.pin(id)._name));
+                    continue;
+                }
+                for (auto f: child[v]->port_nets(k)) {
+                    uf.unite(e, n_base[v] + f);
+                }
+            }
+        }
+    }
+
+    // components, numbered by their smallest node
+    std::vector<std::size_t> comp(nodes, npos);
+    std::vector<std::int64_t> comp_weight;
+    std::size_t ncomp{0};
+    const auto node_weight = [&](std::size_t n, std::size_t v) {
+        return v == npos ? hg.net_weight(n) : child[v]->net_weight(n - n_base[v]);
+    };
+    for (std::size_t n = 0, v = npos; n < nodes; ++n) {
+        while (n >= (v == npos ? own_nets : n_base[v + 1])) v = (v == npos ? 0 : v + 1);
+        const auto r = uf.find(n);
+        if (comp[r] == npos) {
+            comp[r] = ncomp++;
+            comp_weight.emplace_back(std::numeric_limits<std::int64_t>::max());
+        }
+        comp[n] = comp[r];
+        comp_weight[comp[n]] = std::min(comp_weight[comp[n]], node_weight(n, v));
+    }
+
+    // pins of every component, bucketed by counting sort: (vertex, port) records
+    struct Pin {
+        std::size_t vertex;
+        PortId port;
+    };
+    std::vector<std::size_t> c_offsets(ncomp + 1, 0);
+    const auto for_each_pin = [&](auto&& f) {
+        for (std::size_t e = 0; e < hg.num_edges(); ++e) {
+            for (auto p = hg.pin_begin(e); p < hg.pin_begin(e + 1); ++p) {
+                const auto v = hg._e_pins[p];
+                if (child[v]) continue;
+                for (auto id: hg.pin_ports(p)) f(comp[e], Pin{v_base[v], id});
+            }
+        }
+        for (std::size_t v = 0; v < nv; ++v) {
+            if (!child[v]) continue;
+            const auto& c = *child[v];
+            for (std::size_t e = 0; e < c.num_edges(); ++e) {
+                for (auto p = c.pin_begin(e); p < c.pin_begin(e + 1); ++p) {
+                    for (auto id: c.pin_ports(p)) f(comp[n_base[v] + e], Pin{v_base[v] + c._e_pins[p], id});
+                }
+            }
+        }
+    };
+    for_each_pin([&](std::size_t c, const Pin&) { ++c_offsets[c + 1]; });
+    for (std::size_t c = 0; c < ncomp; ++c) c_offsets[c + 1] += c_offsets[c];
+    std::vector<Pin> c_pins(c_offsets.back());
+    {
+        std::vector<std::size_t> fill(c_offsets.begin(), c_offsets.end() - 1);
+        for_each_pin([&](std::size_t c, const Pin& pin) { c_pins[fill[c]++] = pin; });
+    }
+
+    // components that reach a port of mod survive without pins, as boundary nets
+    std::vector<char> on_port(ncomp, 0);
+    for (std::size_t k = 0; k < hg.num_ports(); ++k) {
+        for (auto n: hg.port_nets(k)) on_port[comp[n]] = 1;
+    }
+
+    HyperGraph flat;
+    flat._vertices.reserve(v_base[nv]);
+    flat._v_weights.reserve(v_base[nv]);
+    for (std::size_t v = 0; v < nv; ++v) {
+        if (!child[v]) {
+            flat._vertices.emplace_back(hg._vertices[v]).set_vid(v_base[v]);
+            flat._v_weights.emplace_back(weight[v]);
+            continue;
+        }
+        const auto prefix = std::string(hg.vertex_name(v)) + ".";
+        for (const auto& cv: child[v]->_vertices) {
+            auto& stamped = flat._vertices.emplace_back(cv);
+            stamped.set_vid(v_base[v] + cv.v_id());
+            stamped.set_name(prefix + std::string(cv.name()));
+        }
+        flat._v_weights.insert(flat._v_weights.end(), child[v]->_v_weights.begin(), child[v]->_v_weights.end());
+    }
+
+    std::vector<std::size_t> new_id(ncomp, npos);
+    std::vector<std::size_t> boundary;
+    flat._e_offsets.emplace_back(0);
+    flat._pin_port_offsets.emplace_back(0);
+    for (std::size_t c = 0; c < ncomp; ++c) {
+        auto first = c_pins.begin() + static_cast<std::ptrdiff_t>(c_offsets[c]);
+        auto last = c_pins.begin() + static_cast<std::ptrdiff_t>(c_offsets[c + 1]);
+        if (first == last) {
+            if (on_port[c]) boundary.emplace_back(c);
+            continue;
+        }
+        std::sort(first, last, [](const Pin& a, const Pin& b) { return a.vertex != b.vertex ? a.vertex < b.vertex : a.port < b.port; });
+        for (auto it = first; it != last; ) {
+            const auto v = it->vertex;
+            flat._e_pins.emplace_back(v);
+            for (; it != last && it->vertex == v; ++it) {
+                if (flat._pin_ports.size() == flat._pin_port_offsets.back() || flat._pin_ports.back() != it->port) {
+                    flat._pin_ports.emplace_back(it->port);
+                }
+            }
+            flat._pin_port_offsets.emplace_back(flat._pin_ports.size());
+        }
+        new_id[c] = flat._e_weights.size();
+        flat._e_offsets.emplace_back(flat._e_pins.size());
+        flat._e_weights.emplace_back(comp_weight[c]);
+    }
+    for (auto c: boundary) {
+        new_id[c] = flat._e_weights.size() + flat._b_weights.size();
+        flat._b_weights.emplace_back(comp_weight[c]);
+    }
+
+    flat._port_offsets.assign(hg.num_ports() + 1, 0);
+    for (std::size_t k = 0; k < hg.num_ports(); ++k) {
+        const auto row_begin = flat._port_nets.size();
+        for (auto n: hg.port_nets(k)) flat._port_nets.emplace_back(new_id[comp[n]]);
+        std::sort(flat._port_nets.begin() + static_cast<std::ptrdiff_t>(row_begin), flat._port_nets.end());
+        flat._port_nets.erase(std::unique(flat._port_nets.begin() + static_cast<std::ptrdiff_t>(row_begin), flat._port_nets.end()), flat._port_nets.end());
+        flat._port_offsets[k + 1] = flat._port_nets.size();
+    }
+
+    flat.build_incidence();
+    return flat;
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef FLATTEN_HH
+#define FLATTEN_HH
+
+#include "config.hh"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+namespace parser {
+
+/*
+************************** Hierarchy flattening **************************
+*/
+
+// Expands module instances into the hypergraph of their parent, recursively.
+// Every module is flattened once, bottom-up along the hierarchy, and the result is stamped
+// into each of its instances by offsetting vertex and net ids. A parent net that reaches an
+// instance pin is merged with the nets on the matching port inside (union-find), so the
+// pass is linear in the size of the flattened graph. Flattened cells are named
+// "<instance>.<cell>", as yosys' flatten pass names them.
+//
+// With a max_weight (lazy mode) an instance whose flattened cell count fits in max_weight
+// is not expanded: it stays one super-vertex weighted by that count, and its module is never
+// flattened. Only instances too heavy for a part are opened, and inside them the same rule
+// applies again.
+class Flattener {
+public:
+    Flattener(
+        const std::vector<Module>& modules,
+        const std::unordered_map<std::string, HyperGraph>& graphs,
+        const std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>>& children,
+        const std::unordered_map<std::string, std::size_t>& cell_counts,
+        std::size_t max_weight = 0                          // 0: expand every instance
+    );
+    ~Flattener() = default;
+
+public:
+    auto flatten(const std::string& module_name) -> const HyperGraph&;     // memoized per module
+
+private:
+    struct Instance {
+        const Module* mod;
+        const HyperGraph* flat;                             // nullptr: kept as a super-vertex
+        std::int64_t weight;                                // flattened cell count
+    };
+
+    auto stamp(const Module& mod, const HyperGraph& hg, const std::unordered_map<std::string_view, Instance>& instances) const
+        -> HyperGraph;
+
+private:
+    std::unordered_map<std::string_view, const Module*> _modules;
+    const std::unordered_map<std::string, HyperGraph>& _graphs;
+    const std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>>& _children;
+    const std::unordered_map<std::string, std::size_t>& _cell_counts;
+    std::size_t _max_weight;
+    std::unordered_map<std::string, HyperGraph> _flat;
+    std::unordered_set<std::string> _in_progress;
+};
+
+}
+
+
+#endif  // FLATTEN_HH
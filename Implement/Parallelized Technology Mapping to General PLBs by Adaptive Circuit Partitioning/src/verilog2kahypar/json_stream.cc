@@ -0,0 +1,260 @@
+#include "json_stream.hh"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+
+namespace parser {
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+static void append_utf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+
+JsonStream::JsonStream(std::string_view text)
+    : _begin(text.data()), _cur(text.data()), _end(text.data() + text.size())
+{
+}
+
+auto JsonStream::get() -> char {
+    if (_cur == _end) {
+        error("unexpected end of input");
+    }
+    return *_cur++;
+}
+
+auto JsonStream::skip_ws() -> char {
+    while (_cur < _end) {
+        const char c = *_cur;
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') return c;
+        ++_cur;
+    }
+    return '\0';
+}
+
+auto JsonStream::expect(char c) -> void {
+    if (skip_ws() != c) {
+        error(std::string("expected '") + c + "'");
+    }
+    ++_cur;
+}
+
+auto JsonStream::error(const std::string& msg) const -> void {
+    const auto offset = static_cast<std::size_t>(_cur - _begin);
+    throw std::runtime_error("JSON parse failed at offset " + std::to_string(offset) + ": " + msg);
+}
+
+auto JsonStream::peek() -> Kind {
+    const char c = skip_ws();
+    switch (c) {
+        case '{': return Kind::OBJECT;
+        case '[': return Kind::ARRAY;
+        case '"': return Kind::STRING;
+        case 't': case 'f': case 'n': return Kind::LITERAL;
+        case '\0': return Kind::END;
+        default:
+            if (c == '-' || is_digit(c)) return Kind::NUMBER;
+            error(std::string("unexpected character '") + c + "'");
+    }
+}
+
+auto JsonStream::begin_object() -> void {
+    expect('{');
+    _first.push_back(true);
+}
+
+auto JsonStream::begin_array() -> void {
+    expect('[');
+    _first.push_back(true);
+}
+
+auto JsonStream::next_item(char close) -> bool {
+    if (_first.empty()) {
+        error("no open object or array");
+    }
+    if (skip_ws() == close) {
+        ++_cur;
+        _first.pop_back();
+        return false;
+    }
+    if (_first.back()) {
+        _first.back() = false;
+    } else {
+        expect(',');
+    }
+    return true;
+}
+
+auto JsonStream::next_key(std::string_view& key) -> bool {
+    if (!next_item('}')) return false;
+    key = read_view();
+    expect(':');
+    return true;
+}
+
+auto JsonStream::next_element() -> bool {
+    return next_item(']');
+}
+
+auto JsonStream::read_hex4() -> unsigned {
+    unsigned v{0};
+    for (int i = 0; i < 4; ++i) {
+        const char c = get();
+        v <<= 4;
+        if (is_digit(c)) v |= static_cast<unsigned>(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= static_cast<unsigned>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= static_cast<unsigned>(c - 'A' + 10);
+        else error("invalid \\u escape");
+    }
+    return v;
+}
+
+auto JsonStream::scan_string(std::string* out) -> bool {
+    expect('"');
+    if (out) out->clear();
+    bool escaped = false;
+    while (true) {
+        // copy the plain run up to the next quote or escape in one go
+        const char* p = _cur;
+        while (p < _end && *p != '"' && *p != '\\') ++p;
+        if (out) out->append(_cur, p);
+        _cur = p;
+        if (_cur == _end) {
+            error("unterminated string");
+        }
+        if (*_cur++ == '"') return escaped;
+        escaped = true;
+
+        const char e = get();
+        char c{};
+        switch (e) {
+            case '"': c = '"'; break;
+            case '\\': c = '\\'; break;
+            case '/': c = '/'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'n': c = '\n'; break;
+            case 'r': c = '\r'; break;
+            case 't': c = '\t'; break;
+            case 'u': {
+                unsigned cp = read_hex4();
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    if (get() != '\\' || get() != 'u') error("unpaired surrogate");
+                    const unsigned lo = read_hex4();
+                    if (lo < 0xDC00 || lo > 0xDFFF) error("unpaired surrogate");
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                }
+                if (out) append_utf8(*out, cp);
+                continue;
+            }
+            default: error(std::string("invalid escape '\\") + e + "'");
+        }
+        if (out) out->push_back(c);
+    }
+}
+
+auto JsonStream::read_string(std::string& out) -> void {
+    scan_string(&out);
+}
+
+auto JsonStream::read_view() -> std::string_view {
+    skip_ws();
+    const char* quote = _cur;
+    if (!scan_string(nullptr)) {
+        return std::string_view(quote + 1, static_cast<std::size_t>(_cur - quote - 2));
+    }
+    // escapes have to be decoded, so this one cannot point into the input
+    _cur = quote;
+    scan_string(&_spill.emplace_back());
+    return _spill.back();
+}
+
+auto JsonStream::release_spill() -> std::deque<std::string> {
+    return std::move(_spill);
+}
+
+auto JsonStream::read_uint() -> std::size_t {
+    if (!is_digit(skip_ws())) {
+        error("expected an unsigned integer");
+    }
+    std::size_t v{0};
+    while (_cur < _end && is_digit(*_cur)) {
+        v = v * 10 + static_cast<std::size_t>(*_cur++ - '0');
+    }
+    if (_cur < _end && (*_cur == '.' || *_cur == 'e' || *_cur == 'E')) {
+        error("expected an integer, got a real number");
+    }
+    return v;
+}
+
+auto JsonStream::read_int() -> long long {
+    const bool neg = skip_ws() == '-';
+    if (neg) ++_cur;
+    const auto v = static_cast<long long>(read_uint());
+    return neg ? -v : v;
+}
+
+auto JsonStream::read_raw() -> std::string_view {
+    skip_ws();
+    const char* start = _cur;
+    skip_value();
+    return std::string_view(start, static_cast<std::size_t>(_cur - start));
+}
+
+auto JsonStream::skip_value() -> void {
+    switch (peek()) {
+        case Kind::OBJECT:
+            begin_object();
+            while (next_item('}')) {
+                scan_string(nullptr);
+                expect(':');
+                skip_value();
+            }
+            return;
+        case Kind::ARRAY:
+            begin_array();
+            while (next_item(']')) {
+                skip_value();
+            }
+            return;
+        case Kind::STRING:
+            scan_string(nullptr);
+            return;
+        case Kind::NUMBER:
+            ++_cur;
+            while (_cur < _end
+                && (is_digit(*_cur) || *_cur == '.' || *_cur == 'e' || *_cur == 'E' || *_cur == '+' || *_cur == '-')) {
+                ++_cur;
+            }
+            return;
+        case Kind::LITERAL: {
+            std::string word;
+            while (_cur < _end && *_cur >= 'a' && *_cur <= 'z' && word.size() < 5) {
+                word.push_back(*_cur++);
+            }
+            if (word != "true" && word != "false" && word != "null") error("invalid literal '" + word + "'");
+            return;
+        }
+        case Kind::END:
+            error("unexpected end of input");
+    }
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef JSON_STREAM_HH
+#define JSON_STREAM_HH
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace parser {
+
+/*
+************************** Streaming JSON tokenizer **************************
+*/
+
+// Pull-style JSON reader: the caller walks the document with begin_object()/next_key()
+// and begin_array()/next_element(), reading the scalars it needs as they come.
+// Values the caller does not care about are dropped with skip_value() and never stored.
+// The text is read in place (normally a global::MappedFile), so strings without escapes
+// can be handed out as views into it.
+class JsonStream {
+public:
+    enum class Kind { OBJECT, ARRAY, STRING, NUMBER, LITERAL, END };
+
+    explicit JsonStream(std::string_view text);
+    ~JsonStream() = default;
+
+public:
+    auto peek() -> Kind;
+    auto begin_object() -> void;
+    auto next_key(std::string_view& key) -> bool;   // false once the object is closed
+    auto begin_array() -> void;
+    auto next_element() -> bool;                    // false once the array is closed
+    auto read_string(std::string& out) -> void;
+    auto read_view() -> std::string_view;
+    auto read_uint() -> std::size_t;
+    auto read_int() -> long long;
+    auto read_raw() -> std::string_view;            // the next value as its JSON text, escapes kept
+    auto skip_value() -> void;
+
+    // views of strings that contained escapes point into this store; move it somewhere
+    // that lives as long as the views do
+    auto release_spill() -> std::deque<std::string>;
+
+private:
+    auto get() -> char;
+    auto skip_ws() -> char;                         // next non-space char, '\0' at EOF
+    auto expect(char c) -> void;
+    auto next_item(char close) -> bool;
+    auto scan_string(std::string* out) -> bool;     // out == nullptr only skips; true if escapes were seen
+    auto read_hex4() -> unsigned;
+    [[noreturn]] auto error(const std::string& msg) const -> void;
+
+private:
+    const char* _begin;
+    const char* _cur;
+    const char* _end;
+    std::deque<std::string> _spill;                 // decoded strings handed out by read_view()
+    std::vector<bool> _first;                       // per open container: no item read yet
+};
+
+}
+
+#endif  // JSON_STREAM_HH
@@ -2,6 +2,7 @@
 #include "../global/debug.hh"
 #include <exception>
 #include <iostream>
+#include <string>
 #include <exception>
 
 
@@ -12,8 +13,8 @@ int main(int argc, char* argv[]) {
 try{
     // 检查参数数量
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
-        std::cerr << "Example: " << argv[0] << " config.json" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <filename> [threads] [--flatten | --lazy=<max part weight>] [--snapshot=<path>] [--binary] [--partition=<k> [--epsilon=<e>] [--seed=<s>]]" << std::endl;
+        std::cerr << "Example: " << argv[0] << " config.json 8 --lazy=5000" << std::endl;
         return 1;
     }
     
@@ -21,9 +22,40 @@ try{
     std::string filename = argv[1];
 
     auto reader = parser::Reader();
+    std::string snapshot;
+    parser::PartitionConfig partition{.k = 0};
+    // 其余参数：构建超图的线程数（缺省或 0 表示每个核一个）；--flatten 把子模块实例展开到顶层超图；
+    // --lazy=N 只展开叶子单元数超过 N 的实例，其余实例保留为带权超点；
+    // --snapshot=PATH 把顶层网表写成二进制快照，供 partition2verilog 直接映射；
+    // --binary 另外输出二进制 CSR 超图 (<hMetis 文件>.hgr)；
+    // --partition=K 在进程内做 km1 划分（--epsilon 不平衡度，--seed 随机种子），代替写 hMetis 再调用 KaHyPar
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--flatten") {
+            reader.set_flatten(true);
+        } else if (arg == "--binary") {
+            reader.set_binary(true);
+        } else if (arg.rfind("--snapshot=", 0) == 0) {
+            snapshot = arg.substr(11);
+        } else if (arg.rfind("--lazy=", 0) == 0) {
+            reader.set_lazy(std::stoul(arg.substr(7)));
+        } else if (arg.rfind("--partition=", 0) == 0) {
+            partition.k = std::stoul(arg.substr(12));
+        } else if (arg.rfind("--epsilon=", 0) == 0) {
+            partition.epsilon = std::stod(arg.substr(10));
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            partition.seed = std::stoll(arg.substr(7));
+        } else {
+            reader.set_threads(std::stoul(arg));
+        }
+    }
 
+    reader.set_partition(partition);
     auto module = reader.json2module(filename);
     reader.test_read();
+    if (!snapshot.empty()) {
+        reader.write_snapshot(snapshot);
+    }
     auto hg = reader.modue2hgraph();
     reader.test_hgraph(hg);
     reader.test_hierarchy();
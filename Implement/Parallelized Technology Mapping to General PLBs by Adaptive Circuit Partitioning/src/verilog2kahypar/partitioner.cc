@@ -0,0 +1,551 @@
+#include "partitioner.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <queue>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../global/debug.hh"
+#include "../global/thread_pool.hh"
+
+
+namespace parser {
+
+namespace {
+
+using Block = std::uint32_t;
+
+// One level of the hierarchy, laid out like HyperGraph but with 32-bit ids.
+struct Level {
+    std::vector<std::int64_t> vw;           // vertex weights
+    std::vector<std::int64_t> ew;           // net weights
+    std::vector<std::size_t> eoff{0};
+    std::vector<std::uint32_t> pins;
+    std::vector<std::size_t> voff;
+    std::vector<std::uint32_t> vedges;
+    std::vector<std::uint32_t> up;          // vertex -> its vertex on the next coarser level
+
+    auto n() const -> std::size_t {return vw.size();}
+    auto m() const -> std::size_t {return ew.size();}
+    auto pins_of(std::size_t e) const -> std::span<const std::uint32_t> {
+        return {pins.data() + eoff[e], eoff[e + 1] - eoff[e]};
+    }
+    auto edges_of(std::size_t v) const -> std::span<const std::uint32_t> {
+        return {vedges.data() + voff[v], voff[v + 1] - voff[v]};
+    }
+    auto add_net(std::span<const std::uint32_t> row, std::int64_t weight) -> void {
+        pins.insert(pins.end(), row.begin(), row.end());
+        eoff.emplace_back(pins.size());
+        ew.emplace_back(weight);
+    }
+    auto build_incidence() -> void {
+        voff.assign(n() + 1, 0);
+        for (auto v: pins) ++voff[v + 1];
+        for (std::size_t v = 0; v < n(); ++v) voff[v + 1] += voff[v];
+        vedges.resize(pins.size());
+        auto at = voff;
+        for (std::size_t e = 0; e < m(); ++e) {
+            for (auto v: pins_of(e)) vedges[at[v]++] = static_cast<std::uint32_t>(e);
+        }
+    }
+};
+
+auto row_hash(std::span<const std::uint32_t> row) -> std::uint64_t {
+    std::uint64_t h = 0xCBF29CE484222325ull;
+    for (auto v: row) h = (h ^ v) * 0x100000001B3ull;
+    return h;
+}
+
+// One round of clustering. Returns the coarser level (and fills fine.up), or nothing if
+// the level would shrink by less than 5 %, which is where coarsening stops paying.
+auto coarsen(Level& fine, std::int64_t max_cluster, std::size_t max_net, std::mt19937_64& rng) -> std::optional<Level> {
+    const auto n = fine.n();
+    std::vector<std::uint32_t> cluster(n);                  // leader of the cluster
+    std::iota(cluster.begin(), cluster.end(), 0u);
+    std::vector<std::int64_t> cw(fine.vw);                  // cluster weight, by leader
+    std::vector<char> clustered(n, 0);
+    std::vector<double> score(n, 0.0);
+    std::vector<char> seen(n, 0);
+    std::vector<std::uint32_t> touched;
+    std::vector<std::uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    for (auto u: order) {
+        if (clustered[u]) continue;
+        touched.clear();
+        for (auto e: fine.edges_of(u)) {
+            const auto row = fine.pins_of(e);
+            if (row.size() > max_net) continue;
+            const double s = static_cast<double>(fine.ew[e]) / static_cast<double>(row.size() - 1);
+            for (auto v: row) {
+                if (v == u) continue;
+                const auto c = cluster[v];
+                if (!seen[c]) { seen[c] = 1; touched.emplace_back(c); }
+                score[c] += s;
+            }
+        }
+        // best rated cluster that stays light enough; on equal rating one not formed yet, then the lower id
+        std::uint32_t best = u;
+        double best_score = 0.0;
+        bool best_free = false;
+        for (auto c: touched) {
+            const auto sc = score[c];
+            score[c] = 0.0;
+            seen[c] = 0;
+            if (cw[c] + fine.vw[u] > max_cluster) continue;
+            const bool free = !clustered[c];
+            const bool better = best == u || sc > best_score
+                || (sc == best_score && (free != best_free ? free : c < best));
+            if (better) { best = c; best_score = sc; best_free = free; }
+        }
+        if (best == u) continue;
+        cluster[u] = best;
+        cw[best] += fine.vw[u];
+        clustered[u] = clustered[best] = 1;
+    }
+
+    std::vector<std::uint32_t> id(n, 0);
+    std::uint32_t coarse_n = 0;
+    for (std::size_t v = 0; v < n; ++v) {
+        if (cluster[v] == v) id[v] = coarse_n++;
+    }
+    if (static_cast<std::size_t>(coarse_n) * 100 > n * 95) return std::nullopt;
+
+    fine.up.resize(n);
+    for (std::size_t v = 0; v < n; ++v) fine.up[v] = id[cluster[v]];
+
+    // nets with their pins mapped; single-pin nets are dropped, parallel nets merged
+    Level rows;
+    rows.vw.assign(coarse_n, 0);
+    std::vector<std::uint32_t> row;
+    for (std::size_t e = 0; e < fine.m(); ++e) {
+        row.clear();
+        for (auto v: fine.pins_of(e)) row.emplace_back(fine.up[v]);
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        if (row.size() >= 2) rows.add_net(row, fine.ew[e]);
+    }
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> keys(rows.m());
+    for (std::size_t e = 0; e < rows.m(); ++e) keys[e] = {row_hash(rows.pins_of(e)), static_cast<std::uint32_t>(e)};
+    std::sort(keys.begin(), keys.end());
+    std::vector<std::uint32_t> rep(rows.m());                   // the lowest net with the same pins
+    for (std::size_t i = 0; i < keys.size();) {
+        std::size_t j = i;
+        while (j < keys.size() && keys[j].first == keys[i].first) ++j;
+        for (std::size_t a = i; a < j; ++a) {
+            const auto ea = keys[a].second;
+            rep[ea] = ea;
+            for (std::size_t b = i; b < a; ++b) {
+                const auto eb = keys[b].second;
+                const auto ra = rows.pins_of(ea), rb = rows.pins_of(eb);
+                if (rep[eb] == eb && std::equal(ra.begin(), ra.end(), rb.begin(), rb.end())) { rep[ea] = eb; break; }
+            }
+        }
+        i = j;
+    }
+    std::vector<std::int64_t> merged(rows.m(), 0);
+    for (std::size_t e = 0; e < rows.m(); ++e) merged[rep[e]] += rows.ew[e];
+
+    Level coarse;
+    coarse.vw.resize(coarse_n);
+    for (std::size_t v = 0; v < n; ++v) {
+        if (cluster[v] == v) coarse.vw[id[v]] = cw[v];
+    }
+    for (std::size_t e = 0; e < rows.m(); ++e) {
+        if (rep[e] == e) coarse.add_net(rows.pins_of(e), merged[e]);
+    }
+    coarse.build_incidence();
+    return coarse;
+}
+
+
+// k-way partition of one level with its pin counts per (net, block), which make the
+// km1 gain of a move local: moving v from a to b gains w(e) on every net whose last pin
+// in a it is, and loses w(e) on every net without a pin in b. Both sums are cached per
+// vertex (leave, and conn per block) and kept up to date by every move, so a gain costs
+// O(k) to read and a move only touches the pins of nets that cross a threshold.
+class Refiner {
+public:
+    Refiner(const Level& g, std::size_t k, std::int64_t max_block, std::size_t max_net, std::size_t fm_stop)
+        : _g(g), _k(k), _max_block(max_block), _max_net(max_net), _fm_stop(fm_stop),
+          _bw(k, 0), _phi(g.m() * k, 0), _total(g.n(), 0), _leave(g.n(), 0), _conn(g.n() * k, 0), _stamp(g.n(), 0)
+    {
+        for (std::size_t v = 0; v < g.n(); ++v) {
+            for (auto e: g.edges_of(v)) this->_total[v] += g.ew[e];
+        }
+    }
+
+public:
+    auto assign(std::vector<Block> part) -> void {
+        this->_part = std::move(part);
+        std::fill(this->_bw.begin(), this->_bw.end(), 0);
+        std::fill(this->_phi.begin(), this->_phi.end(), 0);
+        std::fill(this->_leave.begin(), this->_leave.end(), 0);
+        std::fill(this->_conn.begin(), this->_conn.end(), 0);
+        for (std::size_t v = 0; v < this->_g.n(); ++v) this->_bw[this->_part[v]] += this->_g.vw[v];
+        for (std::size_t e = 0; e < this->_g.m(); ++e) {
+            for (auto v: this->_g.pins_of(e)) ++this->phi(e, this->_part[v]);
+        }
+        for (std::size_t v = 0; v < this->_g.n(); ++v) {
+            for (auto e: this->_g.edges_of(v)) {
+                const auto w = this->_g.ew[e];
+                if (this->phi(e, this->_part[v]) == 1) this->_leave[v] += w;
+                for (Block b = 0; b < this->_k; ++b) {
+                    if (this->phi(e, b) > 0) this->_conn[v * this->_k + b] += w;
+                }
+            }
+        }
+    }
+
+    auto part() const -> const std::vector<Block>& {return this->_part;}
+    auto balanced() const -> bool {
+        return std::all_of(this->_bw.begin(), this->_bw.end(), [&](std::int64_t w) { return w <= this->_max_block; });
+    }
+
+    auto km1() const -> std::int64_t {
+        std::int64_t total{0};
+        for (std::size_t e = 0; e < this->_g.m(); ++e) {
+            std::int64_t lambda{0};
+            for (std::size_t b = 0; b < this->_k; ++b) lambda += this->_phi[e * this->_k + b] > 0;
+            total += (lambda - 1) * this->_g.ew[e];
+        }
+        return total;
+    }
+
+    // moves vertices out of overloaded blocks, cheapest first, into blocks they fit in
+    auto rebalance() -> void {
+        std::vector<std::tuple<std::int64_t, std::uint32_t, Block>> candidates;
+        for (int round = 0; round < 4 && !this->balanced(); ++round) {
+            candidates.clear();
+            for (std::uint32_t v = 0; v < this->_g.n(); ++v) {
+                if (this->_bw[this->_part[v]] <= this->_max_block) continue;
+                const auto mv = this->best_move(v, true);
+                if (mv.to != NONE) candidates.emplace_back(mv.gain, v, mv.to);
+            }
+            std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+            for (const auto& [gain, v, to]: candidates) {
+                if (this->_bw[this->_part[v]] <= this->_max_block) continue;
+                if (this->_bw[to] + this->_g.vw[v] > this->_max_block) continue;
+                this->move(v, to);
+            }
+        }
+    }
+
+    auto refine(std::mt19937_64& rng) -> void {
+        this->label_propagation(rng, 5);
+        for (int pass = 0; pass < 5 && this->fm() > 0; ++pass) {}
+    }
+
+private:
+    static constexpr Block NONE = std::numeric_limits<Block>::max();
+    struct Move {
+        Block to;
+        std::int64_t gain;
+    };
+
+    auto phi(std::size_t e, Block b) -> std::uint32_t& {return this->_phi[e * this->_k + b];}
+
+    auto boundary(std::uint32_t v) const -> bool {
+        const auto a = this->_part[v];
+        for (auto e: this->_g.edges_of(v)) {
+            if (this->_phi[e * this->_k + a] < this->_g.pins_of(e).size()) return true;
+        }
+        return false;
+    }
+
+    // the best move of v into a block with room for it: only blocks v shares a net with,
+    // or with `any` every block. NONE if there is none.
+    auto best_move(std::uint32_t v, bool any = false) const -> Move {
+        const auto a = this->_part[v];
+        const auto* conn = this->_conn.data() + v * this->_k;
+        Move best{NONE, 0};
+        for (Block b = 0; b < this->_k; ++b) {
+            if (b == a || (!any && conn[b] == 0)) continue;
+            if (this->_bw[b] + this->_g.vw[v] > this->_max_block) continue;
+            const auto gain = this->_leave[v] - (this->_total[v] - conn[b]);
+            if (best.to == NONE || gain > best.gain || (gain == best.gain && this->_bw[b] < this->_bw[best.to])) {
+                best = Move{b, gain};
+            }
+        }
+        return best;
+    }
+
+    // changed(u) is called for the vertices whose cached gains the move changed (v included),
+    // except for the pins of nets above max_net, which would make every move of theirs costly
+    template <typename Changed>
+    auto move(std::uint32_t v, Block to, Changed&& changed) -> void {
+        const auto from = this->_part[v];
+        const auto k = this->_k;
+        for (auto e: this->_g.edges_of(v)) {
+            const auto w = this->_g.ew[e];
+            const auto row = this->_g.pins_of(e);
+            const auto in_from = --this->phi(e, from);
+            const auto in_to = ++this->phi(e, to);
+            const bool notify = row.size() <= this->_max_net;
+            if (in_from == 0) {                     // from left the net, v was its last pin
+                this->_leave[v] -= w;
+                for (auto u: row) { this->_conn[u * k + from] -= w; if (notify) changed(u); }
+            } else if (in_from == 1) {              // the one pin left in from is now the last
+                for (auto u: row) {
+                    if (u != v && this->_part[u] == from) { this->_leave[u] += w; changed(u); break; }
+                }
+            }
+            if (in_to == 1) {                       // to joined the net, v is its only pin
+                this->_leave[v] += w;
+                for (auto u: row) { this->_conn[u * k + to] += w; if (notify) changed(u); }
+            } else if (in_to == 2) {                // the pin already in to is no longer the last
+                for (auto u: row) {
+                    if (this->_part[u] == to) { this->_leave[u] -= w; changed(u); break; }
+                }
+            }
+        }
+        this->_bw[from] -= this->_g.vw[v];
+        this->_bw[to] += this->_g.vw[v];
+        this->_part[v] = to;
+    }
+
+    auto move(std::uint32_t v, Block to) -> void {
+        this->move(v, to, [](std::uint32_t) {});
+    }
+
+    auto label_propagation(std::mt19937_64& rng, int rounds) -> void {
+        std::vector<std::uint32_t> order(this->_g.n());
+        std::iota(order.begin(), order.end(), 0u);
+        for (int round = 0; round < rounds; ++round) {
+            std::shuffle(order.begin(), order.end(), rng);
+            std::size_t moved{0};
+            for (auto v: order) {
+                if (!this->boundary(v)) continue;
+                const auto mv = this->best_move(v);
+                if (mv.to == NONE || mv.gain <= 0) continue;
+                this->move(v, mv.to);
+                ++moved;
+            }
+            if (moved == 0) break;
+        }
+    }
+
+    // One k-way FM pass: the best move overall is made even when it loses, every vertex
+    // moves at most once, and afterwards the moves past the best prefix are undone. Only
+    // vertices whose gains a move changed are queued again; an entry whose gain has gone
+    // stale since (block weights change too) is requeued when it comes up.
+    auto fm() -> std::int64_t {
+        using Entry = std::tuple<std::int64_t, std::uint32_t, Block>;
+        std::priority_queue<Entry> queue;
+        std::vector<char> locked(this->_g.n(), 0);
+        for (std::uint32_t v = 0; v < this->_g.n(); ++v) {
+            if (!this->boundary(v)) continue;
+            const auto mv = this->best_move(v);
+            if (mv.to != NONE) queue.emplace(mv.gain, v, mv.to);
+        }
+
+        std::vector<std::pair<std::uint32_t, Block>> moves;     // vertex, block it left
+        std::vector<std::uint32_t> changed;
+        std::int64_t current{0}, best{0};
+        std::size_t best_len{0}, since_best{0};
+        while (!queue.empty() && since_best < this->_fm_stop) {
+            const auto [gain, v, to] = queue.top();
+            queue.pop();
+            if (locked[v]) continue;
+            const auto mv = this->best_move(v);
+            if (mv.to == NONE) continue;
+            if (mv.gain != gain || mv.to != to) {
+                queue.emplace(mv.gain, v, mv.to);
+                continue;
+            }
+            moves.emplace_back(v, this->_part[v]);
+            locked[v] = 1;
+            ++this->_epoch;
+            changed.clear();
+            this->move(v, to, [&](std::uint32_t u) {
+                if (locked[u] || this->_stamp[u] == this->_epoch) return;
+                this->_stamp[u] = this->_epoch;
+                changed.emplace_back(u);
+            });
+            current += gain;
+            if (current > best) {
+                best = current;
+                best_len = moves.size();
+                since_best = 0;
+            } else {
+                ++since_best;
+            }
+            for (auto u: changed) {
+                const auto next = this->best_move(u);
+                if (next.to != NONE) queue.emplace(next.gain, u, next.to);
+            }
+        }
+        while (moves.size() > best_len) {
+            this->move(moves.back().first, moves.back().second);
+            moves.pop_back();
+        }
+        return best;
+    }
+
+private:
+    const Level& _g;
+    std::size_t _k;
+    std::int64_t _max_block;
+    std::size_t _max_net;
+    std::size_t _fm_stop;
+    std::vector<Block> _part;
+    std::vector<std::int64_t> _bw;              // block weights
+    std::vector<std::uint32_t> _phi;            // pins of net e in block b at e * k + b
+    std::vector<std::int64_t> _total;           // weight of the nets of v
+    std::vector<std::int64_t> _leave;           // weight of the nets v is the last pin of in its block
+    std::vector<std::int64_t> _conn;            // weight of the nets of v with a pin in b, at v * k + b
+    std::vector<std::uint32_t> _stamp;          // FM: vertices already collected after a move
+    std::uint32_t _epoch{0};
+};
+
+// vertices in random order, each into the lightest block
+auto random_partition(const Level& g, std::size_t k, std::mt19937_64& rng) -> std::vector<Block> {
+    std::vector<std::uint32_t> order(g.n());
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<Block> part(g.n(), 0);
+    std::vector<std::int64_t> bw(k, 0);
+    for (auto v: order) {
+        const auto b = static_cast<Block>(std::min_element(bw.begin(), bw.end()) - bw.begin());
+        part[v] = b;
+        bw[b] += g.vw[v];
+    }
+    return part;
+}
+
+// blocks 0 .. k-2 grown breadth-first from random seeds up to an equal share, the rest is block k-1
+auto bfs_partition(const Level& g, std::size_t k, std::size_t max_net, std::mt19937_64& rng) -> std::vector<Block> {
+    const auto last = static_cast<Block>(k - 1);
+    std::vector<Block> part(g.n(), last);
+    std::vector<char> taken(g.n(), 0);
+    std::vector<std::uint32_t> seeds(g.n());
+    std::iota(seeds.begin(), seeds.end(), 0u);
+    std::shuffle(seeds.begin(), seeds.end(), rng);
+    const auto total = std::accumulate(g.vw.begin(), g.vw.end(), std::int64_t{0});
+    const auto share = (total + static_cast<std::int64_t>(k) - 1) / static_cast<std::int64_t>(k);
+    std::size_t next_seed{0};
+    std::queue<std::uint32_t> frontier;
+    for (Block b = 0; b < last; ++b) {
+        std::int64_t weight{0};
+        frontier = {};
+        while (weight < share) {
+            if (frontier.empty()) {
+                while (next_seed < seeds.size() && taken[seeds[next_seed]]) ++next_seed;
+                if (next_seed == seeds.size()) break;
+                frontier.push(seeds[next_seed]);
+            }
+            const auto v = frontier.front();
+            frontier.pop();
+            if (taken[v]) continue;
+            taken[v] = 1;
+            part[v] = b;
+            weight += g.vw[v];
+            for (auto e: g.edges_of(v)) {
+                const auto row = g.pins_of(e);
+                if (row.size() > max_net) continue;
+                for (auto u: row) {
+                    if (!taken[u]) frontier.push(u);
+                }
+            }
+        }
+    }
+    return part;
+}
+
+}
+
+
+auto Partitioner::partition(const HyperGraph& hg) -> std::vector<std::size_t> {
+    const auto n = hg.num_vertices();
+    const auto k = std::max<std::size_t>(this->_config.k, 1);
+    if (n == 0) return {};
+    if (k == 1) return std::vector<std::size_t>(n, 0);
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error("hypergraph too large to partition: " + std::to_string(n) + " vertices");
+    }
+
+    std::vector<Level> levels(1);
+    {
+        auto& top = levels.front();
+        top.vw.assign(hg.vertex_weights().begin(), hg.vertex_weights().end());
+        top.ew.assign(hg.edge_weights().begin(), hg.edge_weights().end());
+        top.eoff.assign(hg.edge_offsets().begin(), hg.edge_offsets().end());
+        top.pins.assign(hg.edge_pins().begin(), hg.edge_pins().end());
+        top.build_incidence();
+    }
+
+    const auto total = std::accumulate(levels.front().vw.begin(), levels.front().vw.end(), std::int64_t{0});
+    const auto share = (total + static_cast<std::int64_t>(k) - 1) / static_cast<std::int64_t>(k);
+    const auto max_block = static_cast<std::int64_t>(std::floor((1.0 + this->_config.epsilon) * static_cast<double>(share)));
+    const auto limit = this->_config.contraction_limit * k;
+    const auto max_cluster = std::max<std::int64_t>(1, (total + static_cast<std::int64_t>(limit) - 1) / static_cast<std::int64_t>(limit));
+    std::mt19937_64 rng(static_cast<std::uint64_t>(this->_config.seed));
+
+    while (levels.back().n() > limit) {
+        auto coarse = coarsen(levels.back(), max_cluster, this->_config.max_net_size, rng);
+        if (!coarse) break;
+        levels.emplace_back(std::move(*coarse));
+    }
+    const auto& coarsest = levels.back();
+    global::log_info("partitioner: k=" + std::to_string(k) + " max block weight " + std::to_string(max_block)
+        + ", coarsened " + std::to_string(n) + " -> " + std::to_string(coarsest.n()) + " vertices, "
+        + std::to_string(coarsest.m()) + " nets in " + std::to_string(levels.size() - 1) + " levels");
+
+    // initial partitions of the coarsest level; run i always uses the same seed, so the pick
+    // (balanced first, then km1, then the lower run) does not depend on the threads
+    const auto runs = std::max<std::size_t>(this->_config.initial_runs, 1);
+    std::vector<std::vector<Block>> candidates(runs);
+    std::vector<std::pair<bool, std::int64_t>> quality(runs);
+    {
+        const auto threads = this->_config.threads == 0 ? global::default_threads() : this->_config.threads;
+        global::ThreadPool pool(std::min(threads, runs));
+        pool.parallel_for(runs, [&](std::size_t i) {
+            std::mt19937_64 run_rng(static_cast<std::uint64_t>(this->_config.seed) + 0x9E3779B97F4A7C15ull * (i + 1));
+            Refiner r(coarsest, k, max_block, this->_config.max_net_size, this->_config.fm_stop);
+            r.assign(i % 2 == 0 ? random_partition(coarsest, k, run_rng)
+                                : bfs_partition(coarsest, k, this->_config.max_net_size, run_rng));
+            r.rebalance();
+            r.refine(run_rng);
+            candidates[i] = r.part();
+            quality[i] = {!r.balanced(), r.km1()};
+        });
+    }
+    const auto pick = static_cast<std::size_t>(std::min_element(quality.begin(), quality.end()) - quality.begin());
+    auto part = std::move(candidates[pick]);
+    global::log_info("partitioner: initial km1 " + std::to_string(quality[pick].second) + " (run " + std::to_string(pick)
+        + " of " + std::to_string(runs) + (quality[pick].first ? ", imbalanced)" : ")"));
+
+    // project and refine level by level
+    for (std::size_t l = levels.size() - 1; l-- > 0;) {
+        const auto& fine = levels[l];
+        std::vector<Block> projected(fine.n());
+        for (std::size_t v = 0; v < fine.n(); ++v) projected[v] = part[fine.up[v]];
+        Refiner r(fine, k, max_block, this->_config.max_net_size, this->_config.fm_stop);
+        r.assign(std::move(projected));
+        r.refine(rng);
+        part = r.part();
+        levels.pop_back();                  // the coarser level is no longer needed
+    }
+
+    std::vector<std::size_t> result(part.begin(), part.end());
+    std::vector<std::int64_t> bw(k, 0);
+    for (std::size_t v = 0; v < n; ++v) bw[result[v]] += hg.vertex_weight(v);
+    const auto heaviest = *std::max_element(bw.begin(), bw.end());
+    global::log_info("partitioner: km1 " + std::to_string(hg.km1(result)) + ", heaviest block " + std::to_string(heaviest));
+    if (heaviest > max_block) {
+        global::log_warning("partitioner: no partition within epsilon " + std::to_string(this->_config.epsilon) + " found");
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,52 @@
+#ifndef PARTITIONER_HH
+#define PARTITIONER_HH
+
+#include "config.hh"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace parser {
+
+/*
+************************** Multilevel partitioner **************************
+*/
+
+// The knobs follow the names of the KaHyPar preset the flow used (km1_kKaHyPar_sea20.ini).
+struct PartitionConfig {
+    std::size_t k{2};
+    double epsilon{0.03};                   // block weight <= (1 + epsilon) * ceil(total / k)
+    std::int64_t seed{-1};                  // any value, the run is deterministic for a seed
+    std::size_t threads{0};                 // initial partitioning runs, 0: one per core
+    std::size_t contraction_limit{160};     // c-t: coarsen down to about contraction_limit * k vertices
+    std::size_t max_net_size{1000};         // cmaxnet: larger nets are left out of ratings and gain updates
+    std::size_t initial_runs{20};           // i-runs: initial partitions tried on the coarsest graph
+    std::size_t fm_stop{350};               // non-improving FM moves before a pass is abandoned
+};
+
+// k-way partitioning for the connectivity (km1) objective, run on the hypergraph in memory:
+//   coarsening      heavy-edge rating, w(e) / (|e| - 1) summed over shared nets; a vertex
+//                   joins the best rated cluster of a neighbour (preferring unclustered ones)
+//                   as long as the cluster stays below ceil(total / (contraction_limit * k));
+//                   single-pin nets are dropped and parallel nets merged on every level
+//   initial         a pool of random and BFS-grown partitions of the coarsest graph, each
+//                   rebalanced and refined, in parallel; the best balanced one wins
+//   uncoarsening    the partition is projected level by level and refined with label
+//                   propagation followed by k-way FM passes (best prefix kept, rolled back after)
+class Partitioner {
+public:
+    explicit Partitioner(const PartitionConfig& config) : _config(config) {}
+    ~Partitioner() = default;
+
+public:
+    auto partition(const HyperGraph& hg) -> std::vector<std::size_t>;      // block id per vertex
+
+private:
+    PartitionConfig _config;
+};
+
+}
+
+
+#endif  // PARTITIONER_HH
@@ -1,141 +1,269 @@
 #include "reader.hh"
 #include "config.hh"
-#include "../json/json.h"
+#include "json_stream.hh"
+#include "flatten.hh"
+#include "partitioner.hh"
 #include <cstddef>
 #include <fstream>
-#include <iterator>
+#include <functional>
 #include <map>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
-#include <variant>
 #include <set>
+#include <sstream>
 #include <vector>
+#include <exception>
+#include <optional>
+#include <utility>
 #include <algorithm>
 #include "../global/debug.hh"
+#include "../global/hgraph_file.hh"
+#include "../global/mapped_file.hh"
+#include "../global/netlist_snapshot.hh"
+#include "../global/thread_pool.hh"
 
 
 namespace parser {
 
-static PortDirection str2dir(const std::string& s) {
+static PortDirection str2dir(std::string_view s) {
     if (s == "input") return PortDirection::INPUT;
     if (s == "output") return PortDirection::OUTPUT;
     return PortDirection::INOUT;
 }
 
-static std::vector<std::variant<std::size_t, std::string>> parse_bits(const Json::Value& arr) {
-    std::vector<std::variant<std::size_t, std::string>> out;
-    out.reserve(arr.size());
-    for (const auto& v : arr) {
-        if (v.isInt()) {
-            out.emplace_back(static_cast<std::size_t>(v.asInt()));
-        } else if (v.isUInt()) {
-            out.emplace_back(static_cast<std::size_t>(v.asUInt()));
+static BitVector read_bits(JsonStream& js) {
+    BitVector out;
+    js.begin_array();
+    while (js.next_element()) {
+        if (js.peek() == JsonStream::Kind::NUMBER) {
+            const auto id = js.read_uint();
+            if (id >= BIT_CONST_0) {
+                throw std::runtime_error("signal id " + std::to_string(id) + " does not fit a packed bit");
+            }
+            out.emplace_back(static_cast<Bit>(id));
         } else {
-            out.emplace_back(v.asString());
+            out.emplace_back(const_bit(js.read_view()));
         }
     }
     return out;
 }
 
-Module Reader::json2module(const std::string& filename) {
-    global::log_info("Reading json and build ...");
-
-    std::ifstream in(filename);
-    if (!in.good()) {
-        throw std::runtime_error(std::string("Failed to open file: ") + filename);
-    }
-    Json::CharReaderBuilder builder;
-    std::string errs;
-    Json::Value root;
-    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
-    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-    bool ok = reader->parse(content.data(), content.data() + content.size(), &root, &errs);
-    if (!ok) {
-        throw std::runtime_error(std::string("JSON parse failed: ") + errs);
+// a module counts as top when its "top" attribute has any non-zero digit
+static bool read_top_attribute(JsonStream& js) {
+    bool top = false;
+    std::string_view key;
+    js.begin_object();
+    while (js.next_key(key)) {
+        if (key != "top") { js.skip_value(); continue; }
+        if (js.peek() == JsonStream::Kind::STRING) {
+            top = js.read_view().find_first_not_of('0') != std::string_view::npos;
+        } else if (js.peek() == JsonStream::Kind::NUMBER) {
+            top = js.read_int() != 0;
+        } else {
+            js.skip_value();
+        }
     }
+    return top;
+}
 
-    const Json::Value& modules = root["modules"];
-    if (modules.isNull()) {
-        throw std::runtime_error("Missing 'modules' in JSON");
+static void read_port(JsonStream& js, Port& p) {
+    std::string_view key;
+    js.begin_object();
+    while (js.next_key(key)) {
+        if (key == "direction") {
+            p._direction = str2dir(js.read_view());
+        } else if (key == "bits") {
+            p._bits = read_bits(js);
+        } else {
+            js.skip_value();
+        }
     }
-    // find top module name; if none, the first one
-    std::string target;
-    for (const auto& name : modules.getMemberNames()) {
-        const auto& attrs = modules[name]["attributes"];
-        if (attrs.isMember("top")) {
-            const auto s = attrs["top"].asString();
-            bool any_one = false;
-            for (char c : s) {
-                if (c != '0') { any_one = true; break; }
+}
+
+static void read_cell(JsonStream& js, Module& m, Cell& c) {
+    std::map<std::string_view, std::string_view> pdirs;
+    std::map<std::string_view, BitVector> conns;
+    std::string_view key, name;
+
+    js.begin_object();
+    while (js.next_key(key)) {
+        if (key == "hide_name") {
+            c._hide = js.read_int() != 0;
+        } else if (key == "type") {
+            c._type = js.read_view();
+        } else if (key == "port_directions") {
+            js.begin_object();
+            while (js.next_key(name)) {
+                pdirs[name] = js.read_view();
             }
-            if (any_one) { target = name; break; }
+        } else if (key == "connections") {
+            js.begin_object();
+            while (js.next_key(name)) {
+                conns[name] = read_bits(js);
+            }
+        } else if (key == "parameters") {
+            // kept verbatim, they are only passed on (netlist snapshot)
+            c._first_param = static_cast<std::uint32_t>(m._params.size());
+            js.begin_object();
+            while (js.next_key(name)) {
+                m._params.emplace_back(Param{._name = name, ._value = js.read_raw()});
+            }
+            c._param_count = static_cast<std::uint32_t>(m._params.size() - c._first_param);
+        } else {
+            js.skip_value();        // attributes
         }
-        if (target.empty()) target = name;
     }
-    // clear and populate all modules; ensure top module is first
-    _module.clear();
 
-    auto build_module = [&](const std::string& name) {
-        Module m;
-        m._name = name;
-        const Json::Value& modv = modules[name];
-        const Json::Value& ports = modv["ports"];
-        for (const auto& pname : ports.getMemberNames()) {
-            const auto& pval = ports[pname];
-            Port p;
-            p._name = pname;
-            p._direction = str2dir(pval["direction"].asString());
-            p._bits = parse_bits(pval["bits"]);
-            m._ports.emplace(pname, std::make_shared<Port>(p));
-        }
-        const Json::Value& cells = modv["cells"];
-        for (const auto& cname : cells.getMemberNames()) {
-            const auto& cval = cells[cname];
-            Cell c;
-            c._name = cname;
-            c._hide = cval["hide_name"].asInt() != 0;
-            c._type = cval["type"].asString();
-
-            std::unordered_map<std::string, Port> c_p{};
-            const auto& pdirs = cval["port_directions"];
-            const auto& conns = cval["connections"];
-            for (const auto& dname : conns.getMemberNames()) {
-                c_p.emplace(dname, Port{. _name = dname, ._direction = str2dir(pdirs[dname].asString()), ._bits = parse_bits(conns[dname])});
+    // the pins of a cell are one run in the module arena, in name order
+    c._first_pin = static_cast<PortId>(m._pins.size());
+    c._pin_count = static_cast<std::uint32_t>(conns.size());
+    for (auto& [dname, bits]: conns) {
+        const auto it = pdirs.find(dname);
+        m.add_pin(Port{
+            ._name = dname, ._direction = str2dir(it == pdirs.end() ? std::string_view{} : it->second), ._bits = std::move(bits)
+        });
+    }
+}
+
+// sort by name; of several entries with the same name the first one is kept
+template <typename T, typename Name>
+static void sort_unique_by_name(std::vector<T>& items, Name name) {
+    std::stable_sort(items.begin(), items.end(), [&](const T& a, const T& b) { return name(a) < name(b); });
+    items.erase(std::unique(items.begin(), items.end(), [&](const T& a, const T& b) { return name(a) == name(b); }), items.end());
+}
+
+static void read_module(JsonStream& js, Module& m, bool& top) {
+    std::string_view key, name;
+    js.begin_object();
+    while (js.next_key(key)) {
+        if (key == "attributes") {
+            top = read_top_attribute(js);
+        } else if (key == "ports") {
+            js.begin_object();
+            while (js.next_key(name)) {
+                Port p{._name = name, ._direction = PortDirection::INOUT, ._bits = {}};
+                read_port(js, p);
+                m._ports.emplace_back(m.add_pin(std::move(p)));
             }
-            for (auto& [dname, port]: c_p) {
-                c._ports.emplace(dname, std::make_shared<Port>(port));
+        } else if (key == "cells") {
+            js.begin_object();
+            while (js.next_key(name)) {
+                Cell c{._name = name, ._hide = false, ._type = {}, ._first_pin = 0, ._pin_count = 0, ._first_param = 0, ._param_count = 0};
+                read_cell(js, m, c);
+                m._cells.emplace_back(c);
             }
-            
-            m._cells.emplace(cname, std::make_shared<Cell>(c));
+        } else {
+            js.skip_value();        // netnames, parameter_default_values, ...
         }
-        return m;
-    };
+    }
+    sort_unique_by_name(m._ports, [&](PortId id) { return m.pin(id)._name; });
+    sort_unique_by_name(m._cells, [](const Cell& c) { return c._name; });
+}
+
+Module Reader::json2module(const std::string& filename) {
+    global::log_info("Reading json and build ...");
 
-    // build top module first
-    Module top_mod = build_module(target);
-    _module.emplace_back(std::move(top_mod));
-    // build remaining modules
-    for (const auto& name : modules.getMemberNames()) {
-        if (name == target) continue;
-        _module.emplace_back(build_module(name));
+    // the file stays mapped for the lifetime of the Reader: cell and port names point into it
+    std::shared_ptr<const global::MappedFile> input;
+    try {
+        input = std::make_shared<const global::MappedFile>(filename);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("Failed to open file: ") + filename + " (" + e.what() + ")");
     }
 
+    // modules are filled in while the file is tokenized; no DOM is built
+    std::vector<std::pair<Module, bool>> parsed;      // module, is_top
+    bool has_modules = false;
+    JsonStream js(input->view());
+    std::string_view key, name;
+    js.begin_object();
+    while (js.next_key(key)) {
+        if (key != "modules") { js.skip_value(); continue; }
+        has_modules = true;
+        js.begin_object();
+        while (js.next_key(name)) {
+            auto& [m, top] = parsed.emplace_back(Module{}, false);
+            m._name = name;
+            read_module(js, m, top);
+        }
+    }
+    if (!has_modules || parsed.empty()) {
+        throw std::runtime_error("Missing 'modules' in JSON");
+    }
+
+    // keep modules sorted by name; the top module (or the first one if none is marked) goes first
+    std::sort(parsed.begin(), parsed.end(), [](const auto& a, const auto& b) { return a.first._name < b.first._name; });
+    auto target = std::find_if(parsed.begin(), parsed.end(), [](const auto& p) { return p.second; });
+    if (target == parsed.end()) target = parsed.begin();
+    std::rotate(parsed.begin(), target, target + 1);
+
+    _module.clear();
+    _module.reserve(parsed.size());
+    for (auto& [m, top]: parsed) {
+        _module.emplace_back(std::move(m));
+    }
+    _input = std::move(input);
+    _spill = js.release_spill();
+
     build_hierarchy();
     return _module.front();
 }
 
 
-// 还没有实现子模块的展开
+// one module's hypergraph; modules share nothing here, so this runs on any thread
+auto Reader::module2hgraph(const Module& mod, const std::set<std::string, std::less<>>& module_names) -> HyperGraph {
+    // data structures for creating hypergraph
+    std::vector<Vertex> vertices;
+    const auto& module_name = mod._name;
+    vertices.reserve(mod._cells.size() + mod._ports.size());
+
+    // create vertices using cell & port 
+global::log_debug("creating vertices ...");
+    std::size_t v_id{0};
+    for (std::size_t i = 0; i < mod._cells.size(); ++i) {  // using cell
+        const auto c = static_cast<CellId>(i);
+        const auto& cell = mod.cell(c);
+        vertices.emplace_back(v_id++, mod, c);
+        if (module_names.find(cell._type) != module_names.end()) {     // is a module object
+            global::log_debug("cell " + std::string(cell._name) + " is a module cell");
+        }
+    }
+    for (auto port: mod._ports) {  // using port
+        vertices.emplace_back(v_id++, mod, port);
+    }
+global::log_debug("totally created " + std::to_string(vertices.size()) + " vertices");
+
+    // create edges
+global::log_debug("creating edges ...");
+    auto nets = build_nets(mod, vertices);
+
+    // rows of a net are ordered by vertex, so a net on one vertex starts and ends with it
+    for (std::size_t e = 0; e < nets.size(); ++e) {
+        const auto id = nets.vertices[nets.offsets[e]];
+        if (nets.vertices[nets.offsets[e + 1] - 1] == id) {
+            global::log_info(
+            "A port are not connected in vertex index" + std::to_string(id)
+            );
+        }
+    }
+global::log_debug("totally created " + std::to_string(nets.size()) + " edges");
+
+    // create hypergraph; vertices and net rows are moved in and consumed
+global::log_debug("creating hypergraph, with module_name: ..." + module_name);
+    return HyperGraph(mod, std::move(vertices), std::move(nets));
+}
+
+
 std::unordered_map<std::string, HyperGraph> Reader::modue2hgraph() {
 global::log_info("Building hypergraph ...");
 
    // for extending cell modules 
-    std::set<std::string> module_names {};                                      // all module names
+    std::set<std::string, std::less<>> module_names {};                         // all module names
     std::unordered_map<std::string, HyperGraph> name2hg{};                      // for all module hg
-    std::unordered_map<std::string, std::set<std::shared_ptr<Port>>> name2ports{};     // for all module ports
-    std::unordered_map<std::string, std::set<std::shared_ptr<Cell>>> name2cell{};         // for cell_hg to be extended in module
 
     // collect all modules
 global::log_debug("collecting modules ...");
@@ -143,165 +271,40 @@ global::log_debug("collecting modules ...");
         module_names.emplace(mod._name);
     }
 
-    for (const auto& mod : this->_module) {
-        // data structures for creating hypergraph
-        std::vector<Vertex> vertices;
-        std::vector<Edge> edges;
-        std::map<std::vector<std::variant<std::size_t, std::string>>, std::map<std::size_t, std::set<std::shared_ptr<Port>>>> info;  // signal_bit_vector -> <v_id, v_ports>
-        auto module_name = mod._name;
-
-        // create vertices using cell & port 
-global::log_debug("creating vertices ...");
-        std::size_t v_id{0};
-        for (auto& [name, cell]: mod._cells) {  // using cell
-            vertices.emplace_back(name, v_id++, cell);
-            if (module_names.find(cell->_type) != module_names.end()) {                  // is a module object
-                auto iter = name2cell.emplace(module_name, std::set<std::shared_ptr<Cell>>{});
-                iter.first->second.emplace(cell);
-                global::log_debug("cell " + name + " is a module cell");
-            }
-        }
-        for (auto& [name, port]: mod._ports) {  // using port
-            vertices.emplace_back(name, v_id++, port);
-            auto iter = name2ports.emplace(module_name, std::set<std::shared_ptr<Port>>{});
-            iter.first->second.emplace(port);
-        }
-global::log_debug("totally created " + std::to_string(vertices.size()) + " vertices");
-
-        // create edges
-global::log_debug("creating edges ...");
-        for (auto& v: vertices) {
-            auto vid = v.v_id();
-
-            for (const auto& [name, port]: v.port_info()) {
-                const auto& bit_vector = port->_bits;
-                bool found = false;
-
-                for (auto& [key, vids]: info) {
-                    if (partly_contains_bits(key, bit_vector)) {
-                        auto iter = vids.emplace(vid, std::set<std::shared_ptr<Port>>{});
-                        iter.first->second.emplace(port);
-                        found = true;
-                        break;
-                    } 
-                }
-                if (!found) {
-                    info.emplace(bit_vector, std::map<std::size_t, std::set<std::shared_ptr<Port>>>{std::make_pair(vid, std::set<std::shared_ptr<Port>>{port})});
-                }
-            }
-        }
-
-        // collect edges
-global::log_debug("collecting edges ...");
-        std::size_t e_id{0};
-        for (const auto& [_, vid_ports]: info) {
-            edges.emplace_back(e_id++, vid_ports);
-            if (vid_ports.size() <= 1) {
-                const auto& [id, ports] = *vid_ports.begin();
-                global::log_info(
-                "A port are not connected in vertex index" + std::to_string(id)
-                );
+    // modules are built concurrently; what each one logs is held back and written in
+    // module order afterwards, so the log and the result do not depend on scheduling
+    const auto n = this->_module.size();
+    std::vector<std::optional<HyperGraph>> built(n);
+    std::vector<global::LogBuffer> logs(n);
+    std::vector<std::exception_ptr> errors(n);
+    {
+        const auto threads = this->_threads == 0 ? global::default_threads() : this->_threads;
+        global::ThreadPool pool(std::min(threads, std::max<std::size_t>(n, 1)));
+        pool.parallel_for(n, [&](std::size_t i) {
+            global::ScopedLogBuffer capture(logs[i]);
+            try {
+                built[i].emplace(module2hgraph(this->_module[i], module_names));
+            } catch (...) {
+                errors[i] = std::current_exception();
             }
+        });
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        global::flush_log(logs[i]);
+        if (errors[i]) {
+            std::rethrow_exception(errors[i]);
         }
-global::log_debug("totally created " + std::to_string(edges.size()) + " edges");
+        name2hg.try_emplace(this->_module[i]._name, std::move(*built[i]));
+    }
 
-        // create hypergraph
-global::log_debug("creating hypergraph, with module_name: ..." + module_name);
-        name2hg.emplace(module_name, HyperGraph(vertices, edges));
-    }
-    
-    // extend cells in upper level hypergraph（not implement）
-    // for (const auto& [m, cell]: name2cell) {
-    //     const auto& cell_hg = name2hg.at(cell->_type);      // cell hypergraph
-    //     const auto& upper_hg = name2hg.at(m);               // upper_level hypergraph
-    //     auto cell_id_in_upperhg = std::find_if(upper_hg.vertices().begin(), upper_hg.vertices().end(),\
-    //     [&](const auto& v){ return v.name() == cell->_name; }
-    //     )->v_id();
-
-    //     // collect vertices in upper_hg 
-    //     std::vector<Vertex> new_vertices{};
-    //     std::unordered_map<std::size_t, std::size_t> cellhg_old2new_vid;
-    //     new_vertices.insert(new_vertices.end(), upper_hg.vertices().begin(), upper_hg.vertices().end());
-    //     // collect and update v_id in cell_hg
-    //     auto current_v_id = upper_hg.vertices().size();
-    //     for (const auto& v: cell_hg.vertices()) {
-    //         cellhg_old2new_vid.emplace(v.v_id(), current_v_id);
-    //         new_vertices.emplace_back(v.name(), current_v_id++, v.cell());
-    //     }
-    //     // collect edges in upper_hg
-    //     auto new_edges_in_cellhg = std::vector<Edge>{};
-    //     for (auto& edge: upper_hg.edges()) {
-    //         new_edges_in_cellhg.emplace_back(edge);
-    //     }
-    //     // update v_id in edges in cell_hg
-    //     std::unordered_map<std::size_t, std::size_t> cellhg_old2new_eid;
-    //     auto current_e_id = upper_hg.edges().size();
-    //     for (auto& edge: cell_hg.edges()) {
-    //         auto e_id = current_e_id++;
-    //         cellhg_old2new_eid.emplace(edge.e_id(), e_id);
-    //         auto port_map = std::map<std::size_t, std::set<std::shared_ptr<Port>>>{};
-    //         for (auto& [vid, ports]: edge.v_port()) {
-    //             port_map.emplace(cellhg_old2new_vid.at(vid), ports);
-    //         }
-    //         new_edges_in_cellhg.emplace_back(e_id, port_map);
-    //     }
-    //     // create new hypergraph
-    //     auto new_hg = HyperGraph(new_vertices, new_edges_in_cellhg);
-
-    //     // update info in new_hypergraph
-    //     for (const auto& [external_port_name, external_port]: cell->_ports) {
-    //         // collect vid in cell_hg connected with external_port
-    //         auto ex_port_id_in_cellhg = std::find_if(cell_hg.vertices().begin(), cell_hg.vertices().end(),\
-    //         [&](const auto& v){ return v.name() == external_port_name; }
-    //         )->v_id();
-    //         const auto& e_to_external_port = cell_hg.v2e().at(ex_port_id_in_cellhg);
-    //         auto vid_to_external_port = std::vector<std::size_t> {};
-    //         for (const auto& e: e_to_external_port) {
-    //             const auto& edge = cell_hg.edges().at(e);
-    //             for (const auto& [vid, ports]: edge.v_port()) {
-    //                 if (vid != ex_port_id_in_cellhg) {
-    //                     vid_to_external_port.emplace_back(vid);
-    //                     break;
-    //                 }
-    //             }
-    //         }
-    //         //update info in new_hg
-    //         for (const auto& edge_ids: upper_hg.v2e().at(cell_id_in_upperhg)) {
-    //             // edge: an edge in upper_hg, containing cell_id_in_upperhg
-    //             const auto& edge = upper_hg.edges().at(edge_ids);
-    //             // check if the edge contains the external_port
-    //             for (const auto& [vid, ports]: edge.v_port()) {
-    //                 std::shared_ptr<Port> found_port = nullptr;
-    //                 for(const auto& port: ports) {
-    //                     if (port->_name == external_port_name) {
-    //                         found_port = port;
-    //                         break;
-    //                     }
-    //                 }
-    //                 if (vid == cell_id_in_upperhg && found_port) {
-    //                     // the edge contains the external_port, update info of this edge in new_hg
-    //                     new_hg.remove_port_in_edge(edge.e_id(), vid, found_port);
-    //                     for (const auto& vid_in_cellhg: vid_to_external_port) {
-    //                         new_hg.add_port_in_edge(edge.e_id(), cellhg_old2new_vid.at(vid_in_cellhg), found_port);
-    //                     }
-    //                     for (auto eid_in_cellhg: cell_hg.v2e().at(ex_port_id_in_cellhg)) {
-    //                         new_hg.remove_edge(cellhg_old2new_eid.at(eid_in_cellhg));
-    //                         new_hg.remove_edge_in_v2e(ex_port_id_in_cellhg, cellhg_old2new_eid.at(eid_in_cellhg));
-    //                     }
-    //                     new_hg.remove_vertex(cellhg_old2new_vid.at(ex_port_id_in_cellhg));
-    //                     new_hg.add_edge_in_v2e(ex_port_id_in_cellhg, edge.e_id());
-    //                 }
-    //             }
-    //         }
-    //     }
-    //     new_hg.remove_vertex(cell_id_in_upperhg);
-    //     new_hg.remove_all_edge_in_v2e(cell_id_in_upperhg);
-    //     name2hg.at(m) = new_hg;
-    //     name2hg.erase(cell->_type);
-    // }
-
-    // clear external_ports in final_hypergraph
-    // update id in final_hypergraph
+    // expand module instances of the top module down to leaf cells (lazy: only those heavier than a part)
+    if ((this->_flatten || this->_lazy_weight > 0) && !this->_module.empty()) {
+        const auto top = top_module_name();
+        auto flat = Flattener(this->_module, name2hg, this->_hier_children, this->_hier_cells, this->_lazy_weight).flatten(top);
+        global::log_info("Flattened " + top + ": " + std::to_string(flat.num_vertices()) + " vertices, "
+            + std::to_string(flat.num_edges()) + " edges");
+        name2hg.insert_or_assign(top, std::move(flat));
+    }
 
     if (name2hg.size() > 1) {
         global::log_info("Existing isolated module not in top hierarchy!");
@@ -364,85 +367,99 @@ void Reader::test_hierarchy() {
     global::log_debug("Test end");
 }
 
-auto Reader::hgraph2hMetis(const HyperGraph& hg, const std::string& filename, std::size_t mode) -> void {
-    const auto& v2e = hg.v2e();
-
-    // compact vertex indices: map original v_id -> [1..N]
-    std::vector<std::size_t> v_ids;
-    v_ids.reserve(v2e.size());
-    for (const auto& kv : v2e) v_ids.emplace_back(kv.first);
-    std::sort(v_ids.begin(), v_ids.end());
-    std::unordered_map<std::size_t, std::size_t> vmap; // original -> compact 1-based
-    for (std::size_t i = 0; i < v_ids.size(); ++i) vmap.emplace(v_ids[i], i + 1);
-
-    // invert v2e using compact indices
-    std::unordered_map<std::size_t, std::vector<std::size_t>> e2v;
-    e2v.reserve(v2e.size());
-    for (const auto& [v_id, edges] : v2e) {
-        const auto idx = vmap.at(v_id);
-        for (const auto& e_id : edges) {
-            auto& lst = e2v[e_id];
-            lst.emplace_back(idx);
-        }
+static global::SnapshotDirection snapshot_dir(PortDirection d) {
+    switch (d) {
+        case PortDirection::INPUT: return global::SnapshotDirection::INPUT;
+        case PortDirection::OUTPUT: return global::SnapshotDirection::OUTPUT;
+        default: return global::SnapshotDirection::INOUT;
     }
+}
 
-    const std::size_t hyperedge_num = e2v.size();
-    const std::size_t node_num = v_ids.size();
-
-    std::vector<std::size_t> edge_ids;
-    edge_ids.reserve(e2v.size());
-    for (const auto& kv : e2v) edge_ids.emplace_back(kv.first);
-    std::sort(edge_ids.begin(), edge_ids.end());
-
-    std::ofstream out(filename);
-    if (!out.good()) {
-        throw std::runtime_error(std::string("Failed to open hMetis output file: ") + filename);
+// top module as a binary snapshot for partition2verilog; skipped when the file at
+// `filename` was already built from the same JSON
+auto Reader::write_snapshot(const std::string& filename) -> void {
+    if (!this->_input || this->_module.empty()) {
+        throw std::logic_error("write_snapshot called before json2module");
+    }
+    const auto source = this->_input->view();
+    if (global::NetlistSnapshot::matches(filename, source)) {
+        global::log_info("netlist snapshot " + filename + " is up to date");
+        return;
     }
 
-    out << hyperedge_num << ' ' << node_num << ' ' << mode << '\n';
-
-    // edges section
-    const bool edge_w = (mode == 1 || mode == 11);
-    for (auto e_id : edge_ids) {
-        if (edge_w) {
-            out << static_cast<long long>(hg.edge_weight(e_id)) << ' ';
+    static_assert(BIT_CONST_0 == global::SNAPSHOT_CONST_0, "snapshot and reader must pack constants alike");
+    const auto& top = this->_module.front();
+    global::NetlistSnapshotBuilder snap;
+    snap.set_top(top._name);
+    for (auto id: top._ports) {
+        const auto& p = top.pin(id);
+        snap.add_port(p._name, snapshot_dir(p._direction), p._bits);
+    }
+    for (const auto& cell: top._cells) {
+        snap.add_cell(cell._name, cell._type);
+        for (auto id: cell.pins()) {
+            const auto& p = top.pin(id);
+            snap.add_pin(p._name, snapshot_dir(p._direction), p._bits);
         }
-        auto nodes = e2v.at(e_id);
-        std::sort(nodes.begin(), nodes.end());
-        for (std::size_t i = 0; i < nodes.size(); ++i) {
-            if (i) out << ' ';
-            out << nodes[i];
+        for (std::uint32_t i = 0; i < cell._param_count; ++i) {
+            const auto& param = top._params[cell._first_param + i];
+            snap.add_param(param._name, param._value);
         }
-        out << '\n';
     }
+    snap.write(filename, global::content_hash(source), source.size());
+    global::log_info("netlist snapshot of " + top._name + " written: " + filename);
+}
 
-    // vertex weights section
-    const bool vertex_w = (mode == 10 || mode == 11);
-    if (vertex_w) {
-        for (auto v_id : v_ids) {
-            out << static_cast<long long>(hg.vertex_weight(v_id)) << '\n';
-        }
+auto Reader::hgraph2hMetis(const HyperGraph& hg, const std::string& filename, std::size_t mode) -> void {
+    // vertices are numbered 0..n-1 and every edge has pins, hMetis ids are just shifted by one
+    try {
+        global::write_hmetis(filename, mode, hg.num_vertices(), hg.edge_offsets(), hg.edge_pins(), hg.edge_weights(), hg.vertex_weights());
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("Failed to open hMetis output file: ") + filename + " (" + e.what() + ")");
     }
 
-    out.flush();
+    write_names(hg, filename + ".names");
+}
 
-    // write vertex-id to cell-name mapping in the same directory as filename
+// vertex-id to cell-name mapping, hMetis ids (1-based)
+auto Reader::write_names(const HyperGraph& hg, const std::string& filename) -> void {
     try {
-        std::string mapfile = filename + ".names";
-        std::ofstream mout(mapfile);
-        if (mout.good()) {
-            for (auto v_id : v_ids) {
-                auto idx = vmap.at(v_id);
-                auto name = hg.vertex_name(v_id);
-                mout << idx << ' ' << name << '\n';
-            }
-            mout.flush();
+        global::BufferedWriter mout(filename);
+        for (std::size_t v_id = 0; v_id < hg.num_vertices(); ++v_id) {
+            mout.put_int(v_id + 1);
+            mout.put(' ');
+            mout.put(hg.vertex_name(v_id));
+            mout.put('\n');
         }
+        mout.close();
     } catch (...) {
         // ignore mapping file errors silently
     }
 }
 
+// Partitions the graph in process and writes the result as KaHyPar does, one block id per
+// line, to <filename>.part<k>.epsilon<e>.seed<s>.KaHyPar, so partition2verilog reads it as before.
+auto Reader::hgraph2partition(const HyperGraph& hg, const std::string& filename) -> std::string {
+    auto config = this->_partition;
+    config.threads = this->_threads;
+    const auto part = Partitioner(config).partition(hg);
+
+    std::ostringstream name;
+    name << filename << ".part" << config.k << ".epsilon" << config.epsilon << ".seed" << config.seed << ".KaHyPar";
+    global::BufferedWriter out(name.str());
+    for (auto b: part) {
+        out.put_int(b);
+        out.put('\n');
+    }
+    out.close();
+    return name.str();
+}
+
+// the same graph as hgraph2hMetis with both weights, as mappable binary CSR
+auto Reader::hgraph2binary(const HyperGraph& hg, const std::string& filename) -> void {
+    global::write_hgraph_binary(filename, hg.num_vertices(), hg.edge_offsets(), hg.edge_pins(), hg.edge_weights(), hg.vertex_weights());
+}
+
 void Reader::test_hmetis_output(const std::unordered_map<std::string, HyperGraph>& hg, const std::string& filename, std::size_t mode) {
     using namespace global;
     global::log_debug("Testing hgraph2hMetis output ...");
@@ -462,6 +479,17 @@ void Reader::test_hmetis_output(const std::unordered_map<std::string, HyperGraph
         return;
     }
 
+    if (this->_binary) {
+        hgraph2binary(*target, filename + ".hgr");
+        global::log_debug(std::string("binary hypergraph written for module ") + modname + ": " + filename + ".hgr");
+    }
+    if (this->_partition.k > 0) {
+        // partitioned here, the hMetis text and the KaHyPar run are not needed
+        write_names(*target, filename + ".names");
+        const auto part_file = hgraph2partition(*target, filename);
+        global::log_info(std::string("partition of module ") + modname + " written: " + part_file);
+        return;
+    }
     hgraph2hMetis(*target, filename, mode);
     global::log_debug(std::string("hMetis file written for module ") + modname + ": " + filename);
 }
@@ -476,10 +504,10 @@ auto Reader::build_hierarchy() -> void {
         names.emplace(m._name);
     }
     for (const auto& m : _module) {
-        for (const auto& [cname, cell] : m._cells) {
-            const auto& t = cell->_type;
+        for (const auto& cell : m._cells) {
+            const auto t = std::string(cell._type);
             if (names.find(t) != names.end()) {
-                _hier_children[m._name].emplace_back(cname, t);
+                _hier_children[m._name].emplace_back(cell._name, t);
                 _hier_parents[t].insert(m._name);
             }
         }
@@ -489,6 +517,27 @@ auto Reader::build_hierarchy() -> void {
             _hier_roots.emplace_back(n);
         }
     }
+
+    // flattened (leaf) cell count of every module, children before parents
+    _hier_cells.clear();
+    std::unordered_set<std::string> visiting;
+    std::function<std::size_t(const Module&)> count = [&](const Module& m) -> std::size_t {
+        if (const auto it = _hier_cells.find(m._name); it != _hier_cells.end()) return it->second;
+        if (!visiting.insert(m._name).second) {
+            throw std::runtime_error("module " + m._name + " instantiates itself");
+        }
+        std::size_t cells = m._cells.size();
+        if (const auto it = _hier_children.find(m._name); it != _hier_children.end()) {
+            for (const auto& [inst, type] : it->second) {
+                const auto child = std::find_if(_module.begin(), _module.end(), [&](const Module& c) { return c._name == type; });
+                cells = cells - 1 + count(*child);
+            }
+        }
+        return _hier_cells.emplace(m._name, cells).first->second;
+    };
+    for (const auto& m : _module) {
+        count(m);
+    }
 }
 
 auto Reader::top_module_name() const -> std::string {
@@ -502,61 +551,134 @@ auto Reader::hierarchy() const -> const std::unordered_map<std::string, std::vec
 }
 
 
-// 检测 target 是不是一模一样的包含在 bits 中；使用 KMP 算法检测
-bool Reader::partly_contains_bits(
-    const std::vector<std::variant<std::size_t, std::string>>& bits,
-    const std::vector<std::variant<std::size_t, std::string>>& target
-) {
-    auto partly_compare = [&](
-        const std::vector<std::variant<std::size_t, std::string>>& longer, const std::vector<std::variant<std::size_t, std::string>>& shorter
-    ) -> bool {
-        // 预处理：构造KMP的next数组
-        auto build_next = [&](const std::vector<std::variant<std::size_t, std::string>>& pat) {
-            std::vector<int> next(pat.size() + 1, -1);
-            int i = 0, j = -1;
-            while (i < static_cast<int>(pat.size())) {
-                while (j >= 0 && pat[i] != pat[j]) j = next[j];
-                ++i; ++j;
-                next[i] = j;
+// 按 bit 索引构建 net：每个端口只和与它共享 bit 的 net 比较，而不是扫描所有 net。
+// 合并规则与原来的线性扫描一致：端口并入 key 最小的、与之互相包含的 net；
+// 含常量（或为空）的 bit vector 不与其他端口合并，相同的只保留第一个。
+// 每个端口只追加一行 (net, vertex, port)，最后按 net 计数排序成 NetRows，建图过程中没有逐边的分配。
+auto Reader::build_nets(const Module& mod, const std::vector<Vertex>& vertices) -> NetRows
+{
+    constexpr auto npos = static_cast<std::size_t>(-1);
+
+    struct Net {
+        const BitVector* key;                                           // bits of the port that created the net
+    };
+    struct Row {
+        std::size_t net;
+        std::size_t vid;
+        PortId port;
+    };
+    std::vector<Net> nets;
+    std::vector<Row> rows;                                                  // vertices and their ports in ascending order
+    std::unordered_map<Bit, std::vector<std::size_t>> bit2nets;             // bit -> nets whose key contains it
+    std::unordered_map<Bit, std::vector<std::size_t>> head2nets;            // first bit of key -> nets
+    std::unordered_map<BitVector, std::size_t, BitVectorHash> const_keys;   // keys that never merge
+    std::vector<std::size_t> visited;                                       // per-net stamp, dedups candidates
+    std::size_t stamp{0};
+
+    for (const auto& v: vertices) {
+        const auto vid = v.v_id();
+        for (auto port: v.pins()) {
+            const auto& bits = mod.pin(port)._bits;
+            const bool mergeable = !bits.empty() && std::none_of(bits.begin(), bits.end(), is_const_bit);
+
+            std::size_t found{npos};
+            if (mergeable) {
+                ++stamp;
+                auto consider = [&](std::size_t n) {
+                    if (visited[n] == stamp) return;
+                    visited[n] = stamp;
+                    if (found != npos && !(*nets[n].key < *nets[found].key)) return;
+                    if (partly_contains_bits(*nets[n].key, bits)) found = n;
+                };
+                // the port lies inside a key: that key contains bits[0]
+                if (auto it = bit2nets.find(bits.front()); it != bit2nets.end()) {
+                    for (auto n: it->second) consider(n);
+                }
+                // a key lies inside the port: its first bit is one of ours
+                for (const auto& b: bits) {
+                    if (auto it = head2nets.find(b); it != head2nets.end()) {
+                        for (auto n: it->second) consider(n);
+                    }
+                }
             }
-            return next;
-        };
-
-        // 确保 longer.size() >= shorter.size()
-        if (longer.size() < shorter.size()) return false;
-
-        const auto& next = build_next(shorter);
-        int i = 0, j = 0;
-        while (i < static_cast<int>(longer.size())) {
-            while (j >= 0 && longer[i] != shorter[j]) j = next[j];
-            ++i; ++j;
-            if (j == static_cast<int>(shorter.size())) {
-                // 在 longer 中找到完整匹配的连续子串
-                return true;
+            if (found != npos) {
+                rows.push_back(Row{found, vid, port});
+                continue;
             }
-        }
-        return false;
-    };
 
-    // 暂时不支持 bit vector 里面值和字符串混搭的。如果是字符串常量值，就不是不同 cell 端口之间的连接
-    for (auto& v: bits) {
-        if (std::holds_alternative<std::string>(v)) {
-            return false;
-        }
-    }
-    for (auto& v: target) {
-        if (std::holds_alternative<std::string>(v)) {
-            return false;
+            const auto n = nets.size();
+            if (!mergeable && !const_keys.emplace(bits, n).second) {
+                continue;
+            }
+            nets.push_back(Net{&bits});
+            rows.push_back(Row{n, vid, port});
+            visited.push_back(0);
+            if (mergeable) {
+                head2nets[bits.front()].emplace_back(n);
+                for (const auto& b: bits) {
+                    auto& lst = bit2nets[b];
+                    if (lst.empty() || lst.back() != n) lst.emplace_back(n);
+                }
+            }
         }
     }
 
-    if (bits.size() < target.size()) {
-        auto result = partly_compare(target, bits);
-        return result;
-    } else {
-        auto result = partly_compare(bits, target);
-        return result;
+    // number edges in key order, as the std::map keyed by bit vector used to
+    std::vector<std::size_t> order(nets.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return *nets[a].key < *nets[b].key; });
+
+    std::vector<std::size_t> rank(nets.size());
+    for (std::size_t i = 0; i < order.size(); ++i) rank[order[i]] = i;
+
+    // stable counting sort by rank keeps each net's rows in (vertex, port) order
+    NetRows result;
+    result.offsets.assign(nets.size() + 1, 0);
+    for (const auto& r: rows) {
+        ++result.offsets[rank[r.net] + 1];
+    }
+    for (std::size_t e = 0; e < nets.size(); ++e) {
+        result.offsets[e + 1] += result.offsets[e];
     }
+    result.vertices.resize(rows.size());
+    result.ports.resize(rows.size());
+    std::vector<std::size_t> fill(result.offsets.begin(), result.offsets.end() - 1);
+    for (const auto& r: rows) {
+        const auto i = fill[rank[r.net]]++;
+        result.vertices[i] = r.vid;
+        result.ports[i] = r.port;
+    }
+    return result;
 }
 
+
+// 检测 target 是不是一模一样的（连续地）包含在 bits 中，或者反过来。
+// bit 是定长整数，先找首元素再整段比较，两步都是连续内存上的简单循环，可以向量化。
+bool Reader::partly_contains_bits(const BitVector& bits, const BitVector& target) {
+    // 含常量的 bit vector 不是不同 cell 端口之间的连接
+    auto has_const = [](const BitVector& v) {
+        bool any = false;
+        for (auto b: v) any |= is_const_bit(b);
+        return any;
+    };
+    if (has_const(bits) || has_const(target)) {
+        return false;
+    }
+
+    const auto& longer = bits.size() < target.size() ? target : bits;
+    const auto& shorter = bits.size() < target.size() ? bits : target;
+    if (shorter.empty()) {
+        return false;
+    }
+
+    const auto n = shorter.size();
+    const auto last = longer.size() - n;
+    const auto head = shorter.front();
+    for (std::size_t i = 0; i <= last; ++i) {
+        if (longer[i] == head && std::equal(shorter.begin() + 1, shorter.end(), longer.begin() + i + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
 }
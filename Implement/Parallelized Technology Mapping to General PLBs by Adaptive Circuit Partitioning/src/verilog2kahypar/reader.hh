@@ -3,7 +3,14 @@
 
 
 #include "config.hh"
+#include "partitioner.hh"
+#include "../global/mapped_file.hh"
 #include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -18,6 +25,16 @@ public:
     auto json2module(const std::string& filename) -> Module;
     auto modue2hgraph() -> std::unordered_map<std::string, HyperGraph>;
     auto hgraph2hMetis(const HyperGraph& hg, const std::string& filename, std::size_t mode) -> void; 
+    auto hgraph2binary(const HyperGraph& hg, const std::string& filename) -> void;
+    auto hgraph2partition(const HyperGraph& hg, const std::string& filename) -> std::string;   // the part file
+    auto write_names(const HyperGraph& hg, const std::string& filename) -> void;
+    auto write_snapshot(const std::string& filename) -> void;           // top module for partition2verilog
+
+    auto set_threads(std::size_t threads) -> void {this->_threads = threads;}   // 0: one per core
+    auto set_flatten(bool flatten) -> void {this->_flatten = flatten;}         // expand instances in the top hypergraph
+    auto set_lazy(std::size_t max_weight) -> void {this->_lazy_weight = max_weight;}  // expand only instances heavier than this
+    auto set_binary(bool binary) -> void {this->_binary = binary;}             // also write <hmetis file>.hgr
+    auto set_partition(const PartitionConfig& config) -> void {this->_partition = config;}   // k > 0: partition in process
 
     auto build_hierarchy() -> void;
     auto top_module_name() const -> std::string;
@@ -30,15 +47,23 @@ public:
     void test_hmetis_output(const std::unordered_map<std::string, HyperGraph>& hg, const std::string& filename, std::size_t mode);
 
 private:
-    auto partly_contains_bits(
-        const std::vector<std::variant<std::size_t, std::string>>&, const std::vector<std::variant<std::size_t, std::string>>&
-    ) -> bool;
+    auto module2hgraph(const Module& mod, const std::set<std::string, std::less<>>& module_names) -> HyperGraph;
+    auto build_nets(const Module& mod, const std::vector<Vertex>& vertices) -> NetRows;
+    auto partly_contains_bits(const BitVector&, const BitVector&) -> bool;
     
 private:
+    std::shared_ptr<const global::MappedFile> _input;   // backs the names in _module
+    std::deque<std::string> _spill;                     // names that had to be unescaped
     std::vector<Module> _module;
     std::unordered_map<std::string, std::vector<std::pair<std::string, std::string>>> _hier_children;
     std::unordered_map<std::string, std::unordered_set<std::string>> _hier_parents;
     std::vector<std::string> _hier_roots;
+    std::size_t _threads{0};                            // workers for modue2hgraph, 0: one per core
+    bool _flatten{false};
+    std::size_t _lazy_weight{0};                        // 0: lazy mode off
+    bool _binary{false};
+    PartitionConfig _partition{.k = 0};                 // k == 0: write hMetis for an external partitioner
+    std::unordered_map<std::string, std::size_t> _hier_cells;   // module -> flattened cell count
 };
 
 }
@@ -8,10 +8,10 @@ target("verilog2kahypar")
     
     -- 添加源文件
     add_files("src/verilog2kahypar/*.cc")
-    add_files("src/json/jsoncpp.cpp")
     
     -- 头文件目录
     add_includedirs("src")
+    add_syslinks("pthread")
 
     set_targetdir("bin")
     
@@ -29,6 +29,7 @@ target("partition2verilog")
     
     -- 头文件目录
     add_includedirs("src")
+    add_syslinks("pthread")
 
     set_targetdir("bin")
     
@@ -37,3 +38,19 @@ target("partition2verilog")
     add_cflags("-std=c20")
 
     
+
+target("hgraph2hmetis")
+    set_kind("binary")  -- 可执行程序
+    set_default(false)
+
+    -- 二进制 CSR 超图 -> hMetis 文本
+    add_files("src/hgraph2hmetis/*.cc")
+
+    -- 头文件目录
+    add_includedirs("src")
+
+    set_targetdir("bin")
+
+    -- 编译选项
+    add_cxxflags("-Wall", "-Wextra", "-O2")
+    add_cflags("-std=c20")
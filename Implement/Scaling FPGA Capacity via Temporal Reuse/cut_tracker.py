@@ -0,0 +1,130 @@
+"""
+割的增量维护（PartitionAlgorithm 用）
+每个节点存入边/出边的邻接与位宽，移动一个节点只看它自己的边，全局 cutsize 随移动累加。
+优先加载 verilog2dag/dag 编译出的 libcut_tracker（CutTracker 的 C 接口），找不到时用纯 Python 实现，两者接口相同。
+"""
+
+import ctypes
+import os
+from typing import Dict, List, Optional, Tuple
+
+
+_LIB_NAMES = ("libcut_tracker.so", "libcut_tracker.dylib", "cut_tracker.dll")
+
+
+def _load_library() -> Optional[ctypes.CDLL]:
+    """按 CUT_TRACKER_LIB 环境变量、verilog2dag/dag/build 的顺序找共享库"""
+    here = os.path.dirname(os.path.abspath(__file__))
+    candidates = [os.environ.get("CUT_TRACKER_LIB")]
+    candidates += [os.path.join(here, "verilog2dag", "dag", "build", name) for name in _LIB_NAMES]
+    for path in candidates:
+        if not path or not os.path.exists(path):
+            continue
+        try:
+            lib = ctypes.CDLL(path)
+        except OSError:
+            continue
+        u32p = ctypes.POINTER(ctypes.c_uint32)
+        lib.ct_create.restype = ctypes.c_void_p
+        lib.ct_create.argtypes = [ctypes.c_size_t, ctypes.c_size_t, u32p, u32p,
+                                  ctypes.POINTER(ctypes.c_int64), u32p]
+        lib.ct_destroy.restype = None
+        lib.ct_destroy.argtypes = [ctypes.c_void_p]
+        lib.ct_cutsize.restype = ctypes.c_int64
+        lib.ct_cutsize.argtypes = [ctypes.c_void_p]
+        lib.ct_reduction.restype = ctypes.c_int64
+        lib.ct_reduction.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32]
+        lib.ct_move.restype = None
+        lib.ct_move.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32]
+        lib.ct_relabel.restype = None
+        lib.ct_relabel.argtypes = [ctypes.c_void_p, u32p]
+        return lib
+    return None
+
+
+_LIB = _load_library()
+
+
+class CutTracker:
+    """
+    graph 是 implement.Graph（只用到 nodes 与 edges 的 u/v/bitwidth），
+    node_to_partition 是初始分区。之后每次移动都要经过 move，分区号整体重映射后调用 relabel。
+    """
+
+    def __init__(self, graph, node_to_partition: Dict[int, int]):
+        self._index: Dict[int, int] = {node_id: i for i, node_id in enumerate(graph.nodes)}
+        self._handle = None
+        if _LIB is not None:
+            n, m = len(self._index), len(graph.edges)
+            src = (ctypes.c_uint32 * m)(*(self._index[e.u] for e in graph.edges))
+            dst = (ctypes.c_uint32 * m)(*(self._index[e.v] for e in graph.edges))
+            width = (ctypes.c_int64 * m)(*(e.bitwidth for e in graph.edges))
+            self._handle = _LIB.ct_create(n, m, src, dst, width, self._parts(node_to_partition))
+        if self._handle is None:
+            self._build(graph, node_to_partition)
+
+    @property
+    def native(self) -> bool:
+        """是否在用 C++ 实现"""
+        return self._handle is not None
+
+    def __del__(self):
+        if getattr(self, "_handle", None) is not None:
+            _LIB.ct_destroy(self._handle)
+            self._handle = None
+
+    def cutsize(self) -> int:
+        """跨 partition 的边权重之和，O(1)"""
+        if self._handle is not None:
+            return _LIB.ct_cutsize(self._handle)
+        return self._cut
+
+    def reduction(self, node_id: int, to_part: int) -> int:
+        """节点移到 to_part 后 cutsize 的减少量（正数代表减少），O(deg)"""
+        if self._handle is not None:
+            return _LIB.ct_reduction(self._handle, self._index[node_id], to_part)
+        from_part = self._part[node_id]
+        if from_part == to_part:
+            return 0
+        reduction = 0
+        for neighbour, bitwidth in self._adj[node_id]:
+            part = self._part[neighbour]
+            if part == to_part:
+                reduction += bitwidth  # 从跨 partition 变为同 partition
+            elif part == from_part:
+                reduction -= bitwidth  # 从同 partition 变为跨 partition
+        return reduction
+
+    def move(self, node_id: int, to_part: int):
+        """在 node_to_partition 改写前后都可以调用，分区以 tracker 自己记录的为准"""
+        if self._handle is not None:
+            _LIB.ct_move(self._handle, self._index[node_id], to_part)
+            return
+        self._cut -= self.reduction(node_id, to_part)
+        self._part[node_id] = to_part
+
+    def relabel(self, node_to_partition: Dict[int, int]):
+        """partition ID 重新映射后同步（映射一一对应，cutsize 不变）"""
+        if self._handle is not None:
+            _LIB.ct_relabel(self._handle, self._parts(node_to_partition))
+            return
+        self._part = dict(node_to_partition)
+
+    def _parts(self, node_to_partition: Dict[int, int]):
+        parts = (ctypes.c_uint32 * len(self._index))()
+        for node_id, i in self._index.items():
+            parts[i] = node_to_partition[node_id]
+        return parts
+
+    def _build(self, graph, node_to_partition: Dict[int, int]):
+        # 入边与出边都记到两端；自环不会跨 partition，直接跳过
+        self._adj: Dict[int, List[Tuple[int, int]]] = {node_id: [] for node_id in graph.nodes}
+        self._part: Dict[int, int] = dict(node_to_partition)
+        self._cut = 0
+        for edge in graph.edges:
+            if edge.u == edge.v:
+                continue
+            self._adj[edge.u].append((edge.v, edge.bitwidth))
+            self._adj[edge.v].append((edge.u, edge.bitwidth))
+            if self._part[edge.u] != self._part[edge.v]:
+                self._cut += edge.bitwidth
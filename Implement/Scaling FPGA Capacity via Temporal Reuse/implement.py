@@ -15,6 +15,7 @@ import numpy as np
 import sys
 import os
 from datetime import datetime
+from cut_tracker import CutTracker
 
 
 # ==================== 数据结构定义 ====================
@@ -197,6 +198,7 @@ class PartitionAlgorithm:
         self.node_to_partition: Dict[int, int] = {}  # 节点到 partition 的映射
         self.cutsize_history: List[int] = []  # 记录 cutsize 变化历史
         self.size_limit = size_limit
+        self._cut_tracker: Optional[CutTracker] = None  # 初始分区后建立，增量维护 cutsize
     
     def partition(self) -> List[Set[int]]:
         """执行分区算法"""
@@ -266,9 +268,12 @@ class PartitionAlgorithm:
         # 添加最后一个 partition
         if current_partition:
             self.partitions.append(current_partition)
+        self._cut_tracker = CutTracker(self.graph, self.node_to_partition)
     
     def _compute_cutsize(self) -> int:
-        """计算 cutsize（跨 partition 的边权重之和）"""
+        """计算 cutsize（跨 partition 的边权重之和）；初始分区之后由 CutTracker 维护，O(1)"""
+        if self._cut_tracker is not None:
+            return self._cut_tracker.cutsize()
         cutsize = 0
         for edge in self.graph.edges:
             u_part = self.node_to_partition.get(edge.u, -1)
@@ -390,32 +395,9 @@ class PartitionAlgorithm:
             return True  # 无环
     
     def _compute_cutsize_change(self, node_id: int, from_part: int, to_part: int) -> int:
-        """计算移动节点后的 cutsize 变化；注意这里的 reduction 正数代表减少量"""
-        reduction = 0
-        
-        # 检查所有与该节点相关的边
-        for edge in self.graph.edges:
-            if edge.u == node_id:
-                # 出边
-                v_part = self.node_to_partition[edge.v]
-                if from_part != v_part and to_part == v_part:
-                    reduction += edge.bitwidth  # 从跨 partition 变为同 partition
-                elif from_part != v_part and to_part != v_part:
-                    pass  # 仍然是跨 partition
-                elif from_part == v_part and to_part != v_part:
-                    reduction -= edge.bitwidth  # 从同 partition 变为跨 partition
-            
-            if edge.v == node_id:
-                # 入边
-                u_part = self.node_to_partition[edge.u]
-                if u_part != from_part and u_part == to_part:
-                    reduction += edge.bitwidth
-                elif u_part != from_part and u_part != to_part:
-                    pass
-                elif u_part == from_part and u_part != to_part:
-                    reduction -= edge.bitwidth
-        
-        return reduction
+        """计算移动节点后的 cutsize 变化；注意这里的 reduction 正数代表减少量
+        只看该节点自己的入边/出边（CutTracker 的邻接），from_part 即节点当前所在 partition"""
+        return self._cut_tracker.reduction(node_id, to_part)
     
     def _execute_move(self, node_id: int, target_part_id: int, move_info: Dict):
         """执行节点移动"""
@@ -423,11 +405,15 @@ class PartitionAlgorithm:
         self.partitions[current_part_id].remove(node_id)
         self.partitions[target_part_id].add(node_id)
         self.node_to_partition[node_id] = target_part_id
+        self._cut_tracker.move(node_id, target_part_id)
         
         # 清理空 partition
+        num_partitions = len(self.partitions)
         self.partitions = [p for p in self.partitions if p]
         # 重新映射 partition ID
         self._remap_partitions()
+        if len(self.partitions) != num_partitions:
+            self._cut_tracker.relabel(self.node_to_partition)
     
     def _remap_partitions(self):
         """重新映射 partition ID"""
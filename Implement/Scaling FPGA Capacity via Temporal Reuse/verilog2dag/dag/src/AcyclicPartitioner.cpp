@@ -0,0 +1,193 @@
+#include "AcyclicPartitioner.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+std::vector<std::uint32_t> AcyclicPartitioner::run() {
+    initial_partition();
+    CutTracker cut(g_, part_);
+    history_.assign(1, cut.cutsize());
+    QuotientGraph quotient(g_, part_, size_.size());
+    // 增益不会超过节点所有边的位宽之和，桶的范围按它取，再封顶以免一个大扇出节点撑大桶数组
+    std::int64_t range = 1;
+    for (std::size_t v = 0; v < g_.num_nodes(); ++v) {
+        std::int64_t total = 0;
+        for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) total += g_.in_width(i);
+        for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) total += g_.out_width(i);
+        range = std::max(range, total);
+    }
+    GainBuckets buckets(g_.num_nodes(), std::min<std::int64_t>(range, std::int64_t{1} << 20));
+    for (std::size_t pass = 0; pass < options_.max_passes; ++pass) {
+        if (fm_pass(quotient, cut, buckets) <= 0) break;
+        history_.push_back(cut.cutsize());
+    }
+    cut_ = cut.cutsize();
+    compact(quotient);
+    return part_;
+}
+
+// 与 _initial_partition 相同：按拓扑序装箱。拓扑序在前的节点分区号不大于在后的，
+// 所以每条边都从小分区号指向大分区号（或在分区内），分区号就是商图的拓扑序
+void AcyclicPartitioner::initial_partition() {
+    const auto order = g_.topological_order();
+    if (order.size() != g_.num_nodes()) throw std::runtime_error("graph is not acyclic");
+    part_.assign(g_.num_nodes(), 0);
+    resource_.clear();
+    size_.clear();
+    for (auto v : order) {
+        const auto r = g_.resource(v);
+        // 已开的分区都非空，单个超出 resource_limit 的节点独占一个分区
+        if (size_.empty() || resource_.back() + r > options_.resource_limit || size_.back() + 1 > options_.size_limit) {
+            resource_.push_back(0);
+            size_.push_back(0);
+        }
+        part_[v] = static_cast<std::uint32_t>(size_.size() - 1);
+        resource_.back() += r;
+        ++size_.back();
+    }
+}
+
+// 一轮 FM。增益表里只有 v 有邻居的分区（移到别处只会增加割），项里存 v 与该分区的连接
+// 位宽 conn，v 与自己分区的连接存在 own 里，增益 = conn - own。u 从 a 移到 b 后，只有 u 的
+// 未锁定邻居 w 的增益会变：w 在 a 时 own 减少，w 在 b 时 own 增加（两者都改动 w 的全部项），
+// 另外 w 到 a 的 conn 减少、到 b 的 conn 增加。约束（资源、大小、商图无环）会随移动变化，
+// 所以在项被取出时才检查，不满足的项本轮搁置：不再取出，但 conn 继续更新，否则之后重建的项
+// 会漏掉之前的连接，增益偏小
+std::int64_t AcyclicPartitioner::fm_pass(QuotientGraph& quotient, CutTracker& cut, GainBuckets& buckets) {
+    const std::size_t n = g_.num_nodes();
+    const std::size_t parts = size_.size();
+    std::vector<std::int64_t> own(n, 0);
+    std::vector<char> locked(n, 0);
+    std::vector<std::int64_t> conn(parts, 0);     // 建表用，用后清零
+    std::vector<char> seen(parts, 0);
+    std::vector<std::uint32_t> touched;
+    buckets.clear();
+    for (std::uint32_t v = 0; v < n; ++v) {
+        touched.clear();
+        auto add = [&](std::uint32_t p, std::int64_t w) {
+            if (!seen[p]) { seen[p] = 1; touched.push_back(p); }
+            conn[p] += w;
+        };
+        for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) add(part_[g_.in_node(i)], g_.in_width(i));
+        for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) add(part_[g_.out_node(i)], g_.out_width(i));
+        const auto a = part_[v];
+        own[v] = conn[a];
+        for (auto p : touched) {
+            if (p != a) buckets.insert(v, p, conn[p], conn[p] - own[v]);
+        }
+        for (auto p : touched) { conn[p] = 0; seen[p] = 0; }
+    }
+
+    // u 从 a 移到 b 后更新邻居 w（边位宽 w_uw）的项
+    auto neighbour_moved = [&](std::uint32_t w, std::uint32_t a, std::uint32_t b, std::int64_t width) {
+        if (locked[w]) return;
+        const auto p = part_[w];
+        if (p == a || p == b) {
+            own[w] += p == a ? -width : width;
+            for (auto e = buckets.first(w); e != GainBuckets::NONE; e = buckets.next_of_node(e)) {
+                buckets.update(e, buckets[e].conn - own[w]);
+            }
+        }
+        const auto other = p == a ? b : (p == b ? a : GainBuckets::NONE);
+        if (p != a && p != b) {                 // w 在第三个分区：a 的连接减少，b 的连接增加
+            const auto ea = buckets.find(w, a);
+            if (ea != GainBuckets::NONE) {
+                buckets[ea].conn -= width;
+                if (buckets[ea].conn == 0) buckets.erase(ea);
+                else buckets.update(ea, buckets[ea].conn - own[w]);
+            }
+            const auto eb = buckets.find(w, b);
+            if (eb == GainBuckets::NONE) buckets.insert(w, b, width, width - own[w]);
+            else {
+                buckets[eb].conn += width;
+                buckets.update(eb, buckets[eb].conn - own[w]);
+            }
+        } else if (other == b) {                // w 在 a：多了一个到 b 的连接
+            const auto eb = buckets.find(w, b);
+            if (eb == GainBuckets::NONE) buckets.insert(w, b, width, width - own[w]);
+            else {
+                buckets[eb].conn += width;
+                buckets.update(eb, buckets[eb].conn - own[w]);
+            }
+        } else {                                // w 在 b：少了一个到 a 的连接
+            const auto ea = buckets.find(w, a);
+            if (ea != GainBuckets::NONE) {
+                buckets[ea].conn -= width;
+                if (buckets[ea].conn == 0) buckets.erase(ea);
+                else buckets.update(ea, buckets[ea].conn - own[w]);
+            }
+        }
+    };
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> moves;     // 节点，移出的分区
+    std::int64_t current = 0, best = 0;
+    std::size_t best_len = 0, since_best = 0;
+    for (auto e = buckets.top(); e != GainBuckets::NONE && since_best < options_.fm_stop; e = buckets.top()) {
+        const auto v = buckets[e].node;
+        const auto to = buckets[e].part;
+        const auto gain = buckets[e].gain;
+        const auto a = part_[v];
+        const auto r = g_.resource(v);
+        if (resource_[to] + r > options_.resource_limit || size_[to] + 1 > options_.size_limit
+            || quotient.creates_cycle(v, a, to)) {
+            buckets.park(e);
+            continue;
+        }
+        assert(gain == cut.reduction(v, to));   // 增益表与真实割一致（搁置的项 conn 仍在维护）
+        buckets.erase_node(v);
+        locked[v] = 1;
+        move(quotient, cut, v, to);
+        moves.emplace_back(v, a);
+        current += gain;
+        if (current > best) {
+            best = current;
+            best_len = moves.size();
+            since_best = 0;
+        } else {
+            ++since_best;
+        }
+        for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) neighbour_moved(g_.in_node(i), a, to, g_.in_width(i));
+        for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) neighbour_moved(g_.out_node(i), a, to, g_.out_width(i));
+    }
+
+    // 退回到最好的前缀；倒序撤销时每一步都回到一个曾经满足约束的状态
+    while (moves.size() > best_len) {
+        move(quotient, cut, moves.back().first, moves.back().second);
+        moves.pop_back();
+    }
+    return best;
+}
+
+void AcyclicPartitioner::move(QuotientGraph& quotient, CutTracker& cut, std::uint32_t v, std::uint32_t to) {
+    const auto from = part_[v];
+    const auto r = g_.resource(v);
+    quotient.move(v, from, to);
+    cut.move(v, to);
+    resource_[from] -= r;
+    --size_[from];
+    resource_[to] += r;
+    ++size_[to];
+    part_[v] = to;
+}
+
+void AcyclicPartitioner::compact(const QuotientGraph& quotient) {
+    std::vector<std::uint32_t> by_position(size_.size());
+    for (std::uint32_t p = 0; p < size_.size(); ++p) by_position[quotient.position(p)] = p;
+    std::vector<std::int64_t> resource(size_.size());
+    std::vector<std::size_t> size(size_.size());
+    std::vector<std::uint32_t> id(size_.size(), 0);
+    std::size_t kept = 0;
+    for (auto p : by_position) {
+        if (size_[p] == 0) continue;
+        id[p] = static_cast<std::uint32_t>(kept);
+        resource[kept] = resource_[p];
+        size[kept] = size_[p];
+        ++kept;
+    }
+    resource.resize(kept);
+    size.resize(kept);
+    resource_ = std::move(resource);
+    size_ = std::move(size);
+    for (auto& p : part_) p = id[p];
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "CutTracker.h"
+#include "GainBuckets.h"
+#include "QuotientGraph.h"
+#include "WeightedDAG.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// implement.py Algorithm 1（改进 FM 分区）的 C++ 版本：
+//   1. 按拓扑序依次装入分区，装不下 resource_limit 或超过 size_limit 就开新分区；
+//   2. 反复做 FM 轮，直到一轮不再减少 cutsize。每轮从增益表里取增益最大的移动（允许负增益），
+//      每个节点至多移动一次，结束时退回到割最小的前缀。
+// 移动必须保持分区商图无环（由 QuotientGraph 增量判断），且目标分区仍满足 resource_limit 与 size_limit。
+
+struct PartitionOptions {
+    std::int64_t resource_limit = 150;
+    std::size_t size_limit = std::numeric_limits<std::size_t>::max();
+    std::size_t max_passes = 100;       // FM 轮数上限
+    std::size_t fm_stop = 1000;         // 连续这么多步没有刷新最好前缀就结束一轮
+};
+
+class AcyclicPartitioner {
+public:
+    AcyclicPartitioner(const WeightedDAG& g, const PartitionOptions& options) : g_(g), options_(options) {}
+
+    // 返回每个节点的分区号；分区号本身是商图的一个拓扑序，空分区已去掉
+    std::vector<std::uint32_t> run();
+
+    std::int64_t cutsize() const { return cut_; }                           // 跨分区边的位宽之和
+    const std::vector<std::int64_t>& cutsize_history() const { return history_; }   // 初始值与每轮之后
+    std::size_t num_parts() const { return resource_.size(); }
+    std::int64_t part_resource(std::size_t p) const { return resource_[p]; }
+    std::size_t part_size(std::size_t p) const { return size_[p]; }
+
+private:
+    void initial_partition();
+    std::int64_t fm_pass(QuotientGraph& quotient, CutTracker& cut, GainBuckets& buckets);   // 返回割的减少量
+    void move(QuotientGraph& quotient, CutTracker& cut, std::uint32_t v, std::uint32_t to);
+    void compact(const QuotientGraph& quotient);        // 去掉空分区，按商图拓扑序重新编号
+
+    const WeightedDAG& g_;
+    PartitionOptions options_;
+    std::vector<std::uint32_t> part_;
+    std::vector<std::int64_t> resource_;
+    std::vector<std::size_t> size_;
+    std::int64_t cut_ = 0;
+    std::vector<std::int64_t> history_;
+};
@@ -0,0 +1,33 @@
+#include "CutTracker.h"
+
+CutTracker::CutTracker(const WeightedDAG& g, const std::vector<std::uint32_t>& part) : g_(g), part_(part) {
+    reset();
+}
+
+void CutTracker::reset() {
+    cut_ = 0;
+    for (std::size_t u = 0; u < g_.num_nodes(); ++u) {
+        for (std::size_t i = g_.out_begin(u); i < g_.out_end(u); ++i) {
+            if (part_[u] != part_[g_.out_node(i)]) cut_ += g_.out_width(i);
+        }
+    }
+}
+
+// 与 _compute_cutsize_change 相同：邻居在 to 的边不再跨分区，邻居在原分区的边开始跨分区
+std::int64_t CutTracker::reduction(std::uint32_t v, std::uint32_t to) const {
+    const auto from = part_[v];
+    if (from == to) return 0;
+    std::int64_t r = 0;
+    auto visit = [&](std::uint32_t w, std::int64_t width) {
+        const auto p = part_[w];
+        if (p == to) r += width;
+        else if (p == from) r -= width;
+    };
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) visit(g_.in_node(i), g_.in_width(i));
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) visit(g_.out_node(i), g_.out_width(i));
+    return r;
+}
+
+void CutTracker::move(std::uint32_t v, std::uint32_t to) {
+    cut_ -= reduction(v, to);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "WeightedDAG.h"
+#include <cstdint>
+#include <vector>
+
+// 割的增量维护（implement.py 的 _compute_cutsize / _compute_cutsize_change）：
+// 邻接与位宽取自 WeightedDAG 的入/出边 CSR，part 引用调用方的节点分区数组。
+// cutsize() 是 O(1)，reduction 与 move 是 O(deg v)；和 QuotientGraph 一样，move 在改写 part[v] 之前调用。
+
+class CutTracker {
+public:
+    CutTracker(const WeightedDAG& g, const std::vector<std::uint32_t>& part);
+
+    std::int64_t cutsize() const { return cut_; }                   // 跨分区边的位宽之和
+    std::int64_t reduction(std::uint32_t v, std::uint32_t to) const;    // v 移到 to 后割减少多少，可为负
+    void move(std::uint32_t v, std::uint32_t to);
+    void reset();                                                   // part 被整体改写后重新统计
+
+private:
+    const WeightedDAG& g_;
+    const std::vector<std::uint32_t>& part_;
+    std::int64_t cut_ = 0;
+};
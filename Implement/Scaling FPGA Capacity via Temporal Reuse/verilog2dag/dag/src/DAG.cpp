@@ -1,10 +1,13 @@
 #include "DAG.h"
+#include <map>
 #include <sstream>
+#include <utility>
 
-const DAGNode& DAG::add_node(const std::string& id, const std::string& label) {
+const DAGNode& DAG::add_node(const std::string& id, const std::string& label, long long resource) {
     auto it = nodes_.find(id);
     if (it == nodes_.end()) {
-        DAGNode n{ id, label };
+        DAGNode n{ id, label, resource };
+        order_.push_back(id);
         auto res = nodes_.emplace(id, std::move(n));
         return res.first->second;
     }
@@ -35,3 +38,22 @@ std::string DAG::to_dot() const {
     return oss.str();
 }
 
+
+// 格式：
+//   <节点数> <边数>
+//   <resource> <节点 ID>          每个节点一行，行号即节点序号（0 起）
+//   <src> <dst> <bitwidth>        每条边一行
+std::string DAG::to_weighted() const {
+    std::unordered_map<std::string, std::size_t> index;
+    index.reserve(order_.size());
+    for (std::size_t i = 0; i < order_.size(); ++i) index.emplace(order_[i], i);
+
+    std::map<std::pair<std::size_t, std::size_t>, long long> widths;  // 有序，输出稳定
+    for (const auto& e : edges_) ++widths[{ index.at(e.src), index.at(e.dst) }];
+
+    std::ostringstream oss;
+    oss << order_.size() << " " << widths.size() << "\n";
+    for (const auto& id : order_) oss << nodes_.at(id).resource << " " << id << "\n";
+    for (const auto& kv : widths) oss << kv.first.first << " " << kv.first.second << " " << kv.second << "\n";
+    return oss.str();
+}
@@ -9,6 +9,7 @@
 struct DAGNode {
     std::string id;    // 唯一标识，如 CELL:u1 或 PORT:A[0]
     std::string label; // 展示名称
+    long long resource = 1; // cv：单元占 1 份资源，端口为 0
 };
 
 struct DAGEdge {
@@ -19,7 +20,7 @@ struct DAGEdge {
 
 class DAG {
 public:
-    const DAGNode& add_node(const std::string& id, const std::string& label);
+    const DAGNode& add_node(const std::string& id, const std::string& label, long long resource = 1);
     void add_edge(const std::string& src, const std::string& dst, const std::string& via);
     bool has_node(const std::string& id) const;
 
@@ -27,9 +28,12 @@ public:
     const std::vector<DAGEdge>& edges() const { return edges_; }
 
     std::string to_dot() const;
+    // 分区器（dag_partition）的带权 DAG 文本：节点按加入顺序编号，同一对节点间的边合并，位宽为位数
+    std::string to_weighted() const;
 
 private:
     std::unordered_map<std::string, DAGNode> nodes_;
+    std::vector<std::string> order_;  // 节点加入顺序
     std::vector<DAGEdge> edges_;
     std::unordered_set<std::string> edge_set_; // 去重：src|dst|via
 };
@@ -2,14 +2,19 @@
 #include <unordered_map>
 #include <string>
 
-static bool is_output_dir(const std::string& d) { return d == "output"; }
-static bool is_input_dir(const std::string& d) { return d == "input"; }
-
 DAG DAGBuilder::build_for_top(bool include_top_ports) {
     DAG g;
     auto it = design_.modules.find(design_.top);
     if (it == design_.modules.end()) return g;
     const YModule& m = it->second;
+    const auto& S = design_.symbols;
+
+    // 方向比较是符号比较；缺省方向是 NO_SYMBOL，两者都不等
+    auto is_output_dir = [&](Symbol d) { return d == design_.output; };
+    auto is_input_dir = [&](Symbol d) { return d == design_.input; };
+
+    // 节点 ID 每个节点拼一次，引脚只记节点序号
+    std::vector<std::string> node_ids;
 
     // 位到驱动/汇的列表
     std::unordered_map<int, std::vector<PinRef>> drivers;
@@ -19,13 +24,14 @@ DAG DAGBuilder::build_for_top(bool include_top_ports) {
     if (include_top_ports) {
         for (const auto& pkv : m.ports) {
             const YPort& p = pkv.second;
-            std::string nid = std::string("PORT:") + p.name;
-            g.add_node(nid, p.name);
+            const std::string name = S.string(p.name);
+            const PinRef ref{node_ids.size()};
+            node_ids.push_back(std::string("PORT:") + name);
+            g.add_node(node_ids.back(), name, 0);
             for (size_t i = 0; i < p.bits.size(); ++i) {
                 int bit = p.bits[i];
-                std::string plabel = p.name + "[" + std::to_string(i) + "]";
-                if (is_output_dir(p.direction)) drivers[bit].push_back({nid, plabel});
-                if (is_input_dir(p.direction)) sinks[bit].push_back({nid, plabel});
+                if (is_output_dir(p.direction)) drivers[bit].push_back(ref);
+                if (is_input_dir(p.direction)) sinks[bit].push_back(ref);
             }
         }
     }
@@ -33,21 +39,21 @@ DAG DAGBuilder::build_for_top(bool include_top_ports) {
     // 单元节点与端口方向解析
     for (const auto& ckv : m.cells) {
         const YCell& c = ckv.second;
-        std::string nid = std::string("CELL:") + c.name;
-        g.add_node(nid, c.name + " (" + c.type + ")");
+        const std::string name = S.string(c.name);
+        const PinRef ref{node_ids.size()};
+        node_ids.push_back(std::string("CELL:") + name);
+        g.add_node(node_ids.back(), name + " (" + S.string(c.type) + ")");
         for (const auto& conn : c.connections) {
-            const std::string& port = conn.first;
             const auto& bits = conn.second;
-            std::string dir;
-            auto pd = c.port_directions.find(port);
+            Symbol dir = global::NO_SYMBOL;
+            auto pd = c.port_directions.find(conn.first);
             if (pd != c.port_directions.end()) dir = pd->second;
             for (size_t i = 0; i < bits.size(); ++i) {
                 int bit = bits[i];
-                std::string plabel = c.name + ":" + port + "[" + std::to_string(i) + "]";
-                if (is_output_dir(dir)) drivers[bit].push_back({nid, plabel});
-                else if (is_input_dir(dir)) sinks[bit].push_back({nid, plabel});
+                if (is_output_dir(dir)) drivers[bit].push_back(ref);
+                else if (is_input_dir(dir)) sinks[bit].push_back(ref);
                 // 其他方向（inout）暂作为汇
-                else sinks[bit].push_back({nid, plabel});
+                else sinks[bit].push_back(ref);
             }
         }
     }
@@ -59,13 +65,13 @@ DAG DAGBuilder::build_for_top(bool include_top_ports) {
         const auto it2 = sinks.find(bit);
         if (it2 == sinks.end()) continue;
         const auto& ss = it2->second;
+        const std::string via = std::to_string(bit);
         for (const auto& dref : ds) {
             for (const auto& sref : ss) {
-                g.add_edge(dref.node_id, sref.node_id, std::to_string(bit));
+                g.add_edge(node_ids[dref.node], node_ids[sref.node], via);
             }
         }
     }
 
     return g;
 }
-
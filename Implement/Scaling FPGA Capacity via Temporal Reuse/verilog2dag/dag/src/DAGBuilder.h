@@ -1,14 +1,15 @@
 #pragma once
 #include "YosysModel.h"
 #include "DAG.h"
+#include <cstddef>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 // 从 Yosys 模块构建位到驱动/汇的映射，并生成 DAG
 
 struct PinRef {
-    std::string node_id;   // 节点 ID：CELL:<name> 或 PORT:<name>
-    std::string pin_label; // 端口与位的展示，如 port[bit]
+    std::size_t node;      // 节点序号，对应的 ID（CELL:<name> 或 PORT:<name>）每个节点只拼一次
 };
 
 class DAGBuilder {
@@ -0,0 +1,109 @@
+#include "GainBuckets.h"
+#include <algorithm>
+
+GainBuckets::GainBuckets(std::size_t num_nodes, std::int64_t range)
+    : range_(std::max<std::int64_t>(range, 1)),
+      head_(static_cast<std::size_t>(2 * range_ + 1), NONE), node_head_(num_nodes, NONE) {}
+
+void GainBuckets::clear() {
+    if (size_ > 0 || !entries_.empty()) {
+        std::fill(head_.begin(), head_.end(), NONE);
+        std::fill(node_head_.begin(), node_head_.end(), NONE);
+    }
+    entries_.clear();
+    free_.clear();
+    max_ = 0;
+    size_ = 0;
+}
+
+std::size_t GainBuckets::bucket(std::int64_t gain) const {
+    return static_cast<std::size_t>(std::clamp(gain, -range_, range_) + range_);
+}
+
+void GainBuckets::link(std::uint32_t e) {
+    auto& x = entries_[e];
+    const auto b = bucket(x.gain);
+    x.prev = NONE;
+    x.next = head_[b];
+    if (x.next != NONE) entries_[x.next].prev = e;
+    head_[b] = e;
+    max_ = std::max(max_, b);
+}
+
+void GainBuckets::unlink(std::uint32_t e) {
+    const auto& x = entries_[e];
+    if (x.prev != NONE) entries_[x.prev].next = x.next;
+    else head_[bucket(x.gain)] = x.next;
+    if (x.next != NONE) entries_[x.next].prev = x.prev;
+}
+
+std::uint32_t GainBuckets::insert(std::uint32_t node, std::uint32_t part, std::int64_t conn, std::int64_t gain) {
+    std::uint32_t e;
+    if (!free_.empty()) {
+        e = free_.back();
+        free_.pop_back();
+    } else {
+        e = static_cast<std::uint32_t>(entries_.size());
+        entries_.emplace_back();
+    }
+    auto& x = entries_[e];
+    x.node = node;
+    x.part = part;
+    x.conn = conn;
+    x.gain = gain;
+    x.parked = false;
+    x.node_prev = NONE;
+    x.node_next = node_head_[node];
+    if (x.node_next != NONE) entries_[x.node_next].node_prev = e;
+    node_head_[node] = e;
+    link(e);
+    ++size_;
+    return e;
+}
+
+void GainBuckets::update(std::uint32_t e, std::int64_t gain) {
+    if (entries_[e].gain == gain) return;
+    if (entries_[e].parked) {
+        entries_[e].gain = gain;
+        return;
+    }
+    unlink(e);
+    entries_[e].gain = gain;
+    link(e);
+}
+
+void GainBuckets::erase(std::uint32_t e) {
+    const auto& x = entries_[e];
+    if (!x.parked) {
+        unlink(e);
+        --size_;
+    }
+    if (x.node_prev != NONE) entries_[x.node_prev].node_next = x.node_next;
+    else node_head_[x.node] = x.node_next;
+    if (x.node_next != NONE) entries_[x.node_next].node_prev = x.node_prev;
+    free_.push_back(e);
+}
+
+void GainBuckets::park(std::uint32_t e) {
+    if (entries_[e].parked) return;
+    unlink(e);
+    entries_[e].parked = true;
+    --size_;
+}
+
+void GainBuckets::erase_node(std::uint32_t node) {
+    while (node_head_[node] != NONE) erase(node_head_[node]);
+}
+
+std::uint32_t GainBuckets::find(std::uint32_t node, std::uint32_t part) const {
+    for (auto e = node_head_[node]; e != NONE; e = entries_[e].node_next) {
+        if (entries_[e].part == part) return e;
+    }
+    return NONE;
+}
+
+std::uint32_t GainBuckets::top() {
+    if (size_ == 0) return NONE;
+    while (head_[max_] == NONE) --max_;
+    return head_[max_];
+}
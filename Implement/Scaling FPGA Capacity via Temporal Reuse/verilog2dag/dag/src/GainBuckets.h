@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// FM 的增益表：每个 (节点, 目标分区) 一项，只为节点有邻居的分区建项。
+// 项按增益挂在桶（双向链表）里，同一节点的项另串一条链；取最大增益的项是 O(1)（均摊），
+// 增删改也都是 O(1)。增益超出 ±range 的项放在两端的桶里，只在那里不按增益排序。
+// 搁置（park）的项不在桶里、不会被 top 取到，但仍挂在节点链上，conn 照常维护。
+
+class GainBuckets {
+public:
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Entry {
+        std::uint32_t node;
+        std::uint32_t part;
+        std::int64_t conn;      // node 与 part 之间的边位宽
+        std::int64_t gain;      // 移过去割减少多少
+        bool parked;
+        std::uint32_t prev, next;               // 桶链
+        std::uint32_t node_prev, node_next;     // 节点链
+    };
+
+    GainBuckets(std::size_t num_nodes, std::int64_t range);
+
+    void clear();                                       // 每轮开始时清空
+    std::uint32_t insert(std::uint32_t node, std::uint32_t part, std::int64_t conn, std::int64_t gain);
+    void update(std::uint32_t e, std::int64_t gain);    // 改增益并换桶
+    void erase(std::uint32_t e);
+    void park(std::uint32_t e);                         // 本轮不再取出，之后 update 只改增益
+    void erase_node(std::uint32_t node);
+    std::uint32_t find(std::uint32_t node, std::uint32_t part) const;
+    std::uint32_t top();                                // 增益最大的项，没有时 NONE
+
+    Entry& operator[](std::uint32_t e) { return entries_[e]; }
+    const Entry& operator[](std::uint32_t e) const { return entries_[e]; }
+    std::uint32_t first(std::uint32_t node) const { return node_head_[node]; }
+    std::uint32_t next_of_node(std::uint32_t e) const { return entries_[e].node_next; }
+
+private:
+    std::size_t bucket(std::int64_t gain) const;
+    void link(std::uint32_t e);
+    void unlink(std::uint32_t e);
+
+    std::int64_t range_;
+    std::vector<std::uint32_t> head_;       // 桶 -> 第一项
+    std::vector<std::uint32_t> node_head_;  // 节点 -> 第一项
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> free_;
+    std::size_t max_ = 0;                   // 不低于最高的非空桶
+    std::size_t size_ = 0;                  // 桶里的项数，不含搁置的
+};
@@ -128,7 +128,7 @@ Value Parser::parse_number() {
         if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) pos_++;
         while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) pos_++;
     }
-    std::string num = text_.substr(start, pos_ - start);
+    std::string num(text_.substr(start, pos_ - start));
     Value v;
     if (!is_float) {
         v.type = Type::NumberInt;
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <optional>
@@ -35,11 +36,12 @@ struct Value {
 
 class Parser {
 public:
-    explicit Parser(const std::string& text) : text_(text) {}
+    // text 只被引用不被拷贝，解析期间必须保持有效（通常是 global::MappedFile）
+    explicit Parser(std::string_view text) : text_(text) {}
     Value parse();
 
 private:
-    const std::string& text_;
+    std::string_view text_;
     size_t pos_ = 0;
 
     void skip_ws();
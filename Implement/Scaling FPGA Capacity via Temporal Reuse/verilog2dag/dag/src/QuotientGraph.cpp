@@ -0,0 +1,197 @@
+#include "QuotientGraph.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+QuotientGraph::QuotientGraph(const WeightedDAG& g, const std::vector<std::uint32_t>& part, std::size_t num_parts)
+    : g_(g), part_(part), out_(num_parts), in_(num_parts), ord_(num_parts), at_(num_parts),
+      pred_count_(num_parts, 0), succ_count_(num_parts, 0), visited_(num_parts, 0), target_(num_parts, 0) {
+    for (std::size_t u = 0; u < g.num_nodes(); ++u) {
+        for (std::size_t i = g.out_begin(u); i < g.out_end(u); ++i) {
+            const auto a = part[u], b = part[g.out_node(i)];
+            if (a == b) continue;
+            ++out_[a][b];
+            ++in_[b][a];
+        }
+    }
+    // 初始拓扑序：Kahn，入度为 0 的分区按编号先后
+    std::vector<std::size_t> indegree(num_parts);
+    std::size_t placed = 0;
+    for (std::uint32_t p = 0; p < num_parts; ++p) {
+        indegree[p] = in_[p].size();
+        if (indegree[p] == 0) at_[placed++] = p;
+    }
+    for (std::size_t head = 0; head < placed; ++head) {
+        for (const auto& kv : out_[at_[head]]) {
+            if (--indegree[kv.first] == 0) at_[placed++] = kv.first;
+        }
+    }
+    if (placed != num_parts) throw std::runtime_error("partition quotient graph is not acyclic");
+    for (std::uint32_t i = 0; i < num_parts; ++i) ord_[at_[i]] = i;
+}
+
+std::uint32_t QuotientGraph::multiplicity(std::uint32_t a, std::uint32_t b) const {
+    const auto it = out_[a].find(b);
+    return it == out_[a].end() ? 0 : it->second;
+}
+
+void QuotientGraph::next_epoch() const {
+    if (++epoch_ != 0) return;
+    std::fill(visited_.begin(), visited_.end(), 0);
+    std::fill(target_.begin(), target_.end(), 0);
+    epoch_ = 1;
+}
+
+std::uint32_t QuotientGraph::remaining(std::uint32_t a, std::uint32_t b, std::uint32_t count, std::uint32_t from) const {
+    if (a == from) count -= succ_count_[b];
+    else if (b == from) count -= pred_count_[a];
+    return count;
+}
+
+// 原商图无环，新加的边都连着 to，所以新环必然经过 to：从 to 的新出邻居出发，能否走到 to 的
+// 某个新入邻居。除 to 的边以外路径上都是旧边，沿拓扑序递增，所以只需搜索位置不超过
+// 入邻居最大位置的分区；新边都顺着拓扑序时原拓扑序仍然成立，直接返回
+bool QuotientGraph::creates_cycle(std::uint32_t v, std::uint32_t from, std::uint32_t to) const {
+    if (from == to) return false;
+    bool ordered = true;
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v) && ordered; ++i) {
+        const auto p = part_[g_.in_node(i)];
+        ordered = p == to || ord_[p] < ord_[to];
+    }
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v) && ordered; ++i) {
+        const auto p = part_[g_.out_node(i)];
+        ordered = p == to || ord_[p] > ord_[to];
+    }
+    if (ordered) return false;
+
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) ++pred_count_[part_[g_.in_node(i)]];
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) ++succ_count_[part_[g_.out_node(i)]];
+
+    next_epoch();
+    std::int64_t reach = -1;                // 入邻居的最大位置
+    auto mark_target = [&](std::uint32_t p) {
+        target_[p] = epoch_;
+        reach = std::max<std::int64_t>(reach, ord_[p]);
+    };
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) {
+        const auto p = part_[g_.in_node(i)];
+        if (p != to) mark_target(p);
+    }
+    for (const auto& kv : in_[to]) {
+        if (remaining(kv.first, to, kv.second, from) > 0) mark_target(kv.first);
+    }
+
+    stack_.clear();
+    bool cycle = false;
+    auto push = [&](std::uint32_t p) {
+        if (static_cast<std::int64_t>(ord_[p]) > reach || visited_[p] == epoch_) return;
+        visited_[p] = epoch_;
+        stack_.push_back(p);
+        cycle = cycle || target_[p] == epoch_;
+    };
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) {
+        const auto p = part_[g_.out_node(i)];
+        if (p != to) push(p);
+    }
+    for (const auto& kv : out_[to]) {
+        if (remaining(to, kv.first, kv.second, from) > 0) push(kv.first);
+    }
+    while (!stack_.empty() && !cycle) {
+        const auto p = stack_.back();
+        stack_.pop_back();
+        for (const auto& kv : out_[p]) {
+            if (kv.first != to && remaining(p, kv.first, kv.second, from) > 0) push(kv.first);
+        }
+    }
+
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) pred_count_[part_[g_.in_node(i)]] = 0;
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) succ_count_[part_[g_.out_node(i)]] = 0;
+    return cycle;
+}
+
+// 先删后加：删边不破坏拓扑序；每条新出现的边加入时若逆序就立刻重排，
+// 重排时除这条边外其余边都已顺序，正是 Pearce–Kelly 的前提
+void QuotientGraph::move(std::uint32_t v, std::uint32_t from, std::uint32_t to) {
+    if (from == to) return;
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) {
+        const auto p = part_[g_.in_node(i)];
+        if (p != from) remove_edge(p, from);
+    }
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) {
+        const auto p = part_[g_.out_node(i)];
+        if (p != from) remove_edge(from, p);
+    }
+    for (std::size_t i = g_.in_begin(v); i < g_.in_end(v); ++i) {
+        const auto p = part_[g_.in_node(i)];
+        if (p != to) add_edge(p, to);
+    }
+    for (std::size_t i = g_.out_begin(v); i < g_.out_end(v); ++i) {
+        const auto p = part_[g_.out_node(i)];
+        if (p != to) add_edge(to, p);
+    }
+}
+
+void QuotientGraph::add_edge(std::uint32_t a, std::uint32_t b) {
+    ++in_[b][a];
+    if (out_[a][b]++ == 0 && ord_[a] > ord_[b]) insert_order(a, b);
+}
+
+void QuotientGraph::remove_edge(std::uint32_t a, std::uint32_t b) {
+    auto it = out_[a].find(b);
+    if (it == out_[a].end()) throw std::logic_error("quotient edge underflow");
+    if (--it->second == 0) {
+        out_[a].erase(it);
+        in_[b].erase(a);
+    } else {
+        --in_[b][a];
+    }
+}
+
+// Pearce–Kelly：y 向前、x 向后各搜一遍，只看位置在 [ord y, ord x] 之间的分区；
+// 把两次搜到的分区占的位置排序后，先放 x 一侧（δB）再放 y 一侧（δF），各自保持原相对顺序
+void QuotientGraph::insert_order(std::uint32_t x, std::uint32_t y) {
+    const auto lb = ord_[y], ub = ord_[x];
+    next_epoch();
+    std::vector<std::uint32_t> forward, backward;
+    stack_.assign(1, y);
+    visited_[y] = epoch_;
+    while (!stack_.empty()) {
+        const auto p = stack_.back();
+        stack_.pop_back();
+        forward.push_back(p);
+        for (const auto& kv : out_[p]) {
+            const auto q = kv.first;
+            if (q == x) throw std::logic_error("quotient graph move creates a cycle");
+            if (ord_[q] < ub && visited_[q] != epoch_) {
+                visited_[q] = epoch_;
+                stack_.push_back(q);
+            }
+        }
+    }
+    stack_.assign(1, x);
+    visited_[x] = epoch_;
+    while (!stack_.empty()) {
+        const auto p = stack_.back();
+        stack_.pop_back();
+        backward.push_back(p);
+        for (const auto& kv : in_[p]) {
+            const auto q = kv.first;
+            if (ord_[q] > lb && visited_[q] != epoch_) {
+                visited_[q] = epoch_;
+                stack_.push_back(q);
+            }
+        }
+    }
+
+    auto by_position = [&](std::uint32_t a, std::uint32_t b) { return ord_[a] < ord_[b]; };
+    std::sort(forward.begin(), forward.end(), by_position);
+    std::sort(backward.begin(), backward.end(), by_position);
+    std::vector<std::uint32_t> slots;
+    slots.reserve(forward.size() + backward.size());
+    for (auto p : backward) slots.push_back(ord_[p]);
+    for (auto p : forward) slots.push_back(ord_[p]);
+    std::sort(slots.begin(), slots.end());
+    std::size_t i = 0;
+    for (auto p : backward) { ord_[p] = slots[i]; at_[slots[i++]] = p; }
+    for (auto p : forward) { ord_[p] = slots[i]; at_[slots[i++]] = p; }
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "WeightedDAG.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 分区商图（implement.py 的超图 Gs）：节点是分区，a -> b 的重数是从 a 指向 b 的原图边数。
+// 重数随每次移动增减，同时维护一个动态拓扑序（Pearce–Kelly），于是
+//   creates_cycle 只搜索 [新出边终点, 新入边起点] 这段拓扑序之间的分区；
+//   move 更新 O(deg v) 个重数，只有新边逆序时才在受影响区间内重排。
+// part 引用分区器的节点分区数组，移动时由调用方在 move 之后改写 part[v]。
+
+class QuotientGraph {
+public:
+    QuotientGraph(const WeightedDAG& g, const std::vector<std::uint32_t>& part, std::size_t num_parts);
+
+    // 把 v 从 from 移到 to 后商图是否有环；不改变任何状态
+    bool creates_cycle(std::uint32_t v, std::uint32_t from, std::uint32_t to) const;
+    // 提交移动（调用方保证无环）；此时 part[v] 仍是 from
+    void move(std::uint32_t v, std::uint32_t from, std::uint32_t to);
+
+    std::uint32_t position(std::uint32_t p) const { return ord_[p]; }      // 在拓扑序中的位置
+    std::uint32_t multiplicity(std::uint32_t a, std::uint32_t b) const;
+
+private:
+    void add_edge(std::uint32_t a, std::uint32_t b);
+    void remove_edge(std::uint32_t a, std::uint32_t b);
+    void insert_order(std::uint32_t x, std::uint32_t y);    // 新边 x -> y 逆序时重排
+    // 查询时去掉 v 自己贡献的重数：a -> b 原有 count 条边，v 移走后还剩多少
+    std::uint32_t remaining(std::uint32_t a, std::uint32_t b, std::uint32_t count, std::uint32_t from) const;
+    void next_epoch() const;                                // 换一批 visited_/target_ 标记
+
+    const WeightedDAG& g_;
+    const std::vector<std::uint32_t>& part_;
+    std::vector<std::unordered_map<std::uint32_t, std::uint32_t>> out_;    // 重数为 0 的边不保留
+    std::vector<std::unordered_map<std::uint32_t, std::uint32_t>> in_;
+    std::vector<std::uint32_t> ord_;        // 分区 -> 位置
+    std::vector<std::uint32_t> at_;         // 位置 -> 分区
+
+    // 搜索用的临时数组，全部按分区编号；creates_cycle 是 const，所以是 mutable
+    mutable std::vector<std::uint32_t> pred_count_;    // v 在各分区的前驱数
+    mutable std::vector<std::uint32_t> succ_count_;    // v 在各分区的后继数
+    mutable std::vector<std::uint32_t> visited_;
+    mutable std::vector<std::uint32_t> target_;
+    mutable std::uint32_t epoch_ = 0;
+    mutable std::vector<std::uint32_t> stack_;
+};
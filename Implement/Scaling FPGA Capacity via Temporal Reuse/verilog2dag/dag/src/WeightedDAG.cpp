@@ -0,0 +1,175 @@
+#include "WeightedDAG.h"
+#include "global/mapped_file.hh"
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+WeightedDAG::WeightedDAG(std::vector<std::int64_t> resources, std::vector<WeightedEdge> edges, std::vector<std::string> names)
+    : resource_(std::move(resources)), names_(std::move(names)) {
+    if (!names_.empty() && names_.size() != resource_.size()) throw std::invalid_argument("one name per node expected");
+    build(std::move(edges));
+}
+
+// 边按 (u, v) 排序后合并重复边（位宽相加），自环丢弃，再计数建两份 CSR
+void WeightedDAG::build(std::vector<WeightedEdge> edges) {
+    const std::size_t n = resource_.size();
+    for (const auto& e : edges) {
+        if (e.u >= n || e.v >= n) throw std::out_of_range("edge endpoint out of range");
+    }
+    std::sort(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b) {
+        return a.u != b.u ? a.u < b.u : a.v < b.v;
+    });
+    std::size_t kept = 0;
+    for (const auto& e : edges) {
+        if (e.u == e.v) continue;
+        if (kept > 0 && edges[kept - 1].u == e.u && edges[kept - 1].v == e.v) edges[kept - 1].bitwidth += e.bitwidth;
+        else edges[kept++] = e;
+    }
+    edges.resize(kept);
+
+    out_off_.assign(n + 1, 0);
+    in_off_.assign(n + 1, 0);
+    for (const auto& e : edges) {
+        ++out_off_[e.u + 1];
+        ++in_off_[e.v + 1];
+    }
+    for (std::size_t v = 0; v < n; ++v) {
+        out_off_[v + 1] += out_off_[v];
+        in_off_[v + 1] += in_off_[v];
+    }
+    out_adj_.resize(kept);
+    out_width_.resize(kept);
+    in_adj_.resize(kept);
+    in_width_.resize(kept);
+    std::vector<std::size_t> in_at(in_off_.begin(), in_off_.end() - 1);
+    for (std::size_t i = 0; i < kept; ++i) {       // 已按 u 排序，出边就是原顺序
+        const auto& e = edges[i];
+        out_adj_[i] = e.v;
+        out_width_[i] = e.bitwidth;
+        in_adj_[in_at[e.v]] = e.u;
+        in_width_[in_at[e.v]++] = e.bitwidth;
+    }
+}
+
+WeightedDAG WeightedDAG::read(const std::string& path) {
+    global::MappedFile file(path);
+    const std::string_view text = file.view();
+    std::size_t pos = 0;
+    std::size_t line = 1;
+    auto fail = [&](const char* what) -> void {
+        throw std::runtime_error(path + ":" + std::to_string(line) + ": " + what);
+    };
+    auto skip_blank = [&]() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r')) ++pos;
+    };
+    auto end_line = [&]() {
+        skip_blank();
+        if (pos < text.size() && text[pos] != '\n') fail("unexpected text at end of line");
+        if (pos < text.size()) ++pos;
+        ++line;
+    };
+    auto number = [&](auto& out) {
+        skip_blank();
+        const auto r = std::from_chars(text.data() + pos, text.data() + text.size(), out);
+        if (r.ec != std::errc()) fail("number expected");
+        pos = static_cast<std::size_t>(r.ptr - text.data());
+    };
+
+    std::size_t n = 0, m = 0;
+    number(n);
+    number(m);
+    end_line();
+
+    std::vector<std::int64_t> resources(n);
+    std::vector<std::string> names(n);
+    for (std::size_t v = 0; v < n; ++v) {
+        number(resources[v]);
+        skip_blank();
+        const auto eol = std::min(text.find('\n', pos), text.size());
+        auto name = text.substr(pos, eol - pos);
+        while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.remove_suffix(1);
+        names[v] = std::string(name);
+        pos = eol;
+        end_line();
+    }
+    std::vector<WeightedEdge> edges(m);
+    for (auto& e : edges) {
+        number(e.u);
+        number(e.v);
+        number(e.bitwidth);
+        end_line();
+    }
+    return WeightedDAG(std::move(resources), std::move(edges), std::move(names));
+}
+
+std::vector<std::uint32_t> WeightedDAG::topological_order() const {
+    const std::size_t n = num_nodes();
+    std::vector<std::size_t> indegree(n);
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    for (std::size_t v = 0; v < n; ++v) {
+        indegree[v] = in_end(v) - in_begin(v);
+        if (indegree[v] == 0) order.push_back(static_cast<std::uint32_t>(v));
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {      // order 本身就是 FIFO 队列
+        const auto u = order[head];
+        for (std::size_t i = out_begin(u); i < out_end(u); ++i) {
+            if (--indegree[out_adj_[i]] == 0) order.push_back(out_adj_[i]);
+        }
+    }
+    if (order.size() != n) order.clear();
+    return order;
+}
+
+std::size_t WeightedDAG::remove_back_edges() {
+    const std::size_t n = num_nodes();
+    enum : char { NEW, ACTIVE, DONE };
+    std::vector<char> state(n, NEW);
+    std::vector<char> back(num_edges(), 0);
+    std::vector<std::pair<std::uint32_t, std::size_t>> stack;      // 节点，下一条出边
+    std::size_t removed = 0;
+    for (std::size_t root = 0; root < n; ++root) {
+        if (state[root] != NEW) continue;
+        state[root] = ACTIVE;
+        stack.emplace_back(static_cast<std::uint32_t>(root), out_begin(root));
+        while (!stack.empty()) {
+            auto& [u, i] = stack.back();
+            if (i == out_end(u)) {
+                state[u] = DONE;
+                stack.pop_back();
+                continue;
+            }
+            const auto edge = i++;
+            const auto w = out_adj_[edge];
+            if (state[w] == ACTIVE) {
+                back[edge] = 1;
+                ++removed;
+            } else if (state[w] == NEW) {
+                state[w] = ACTIVE;
+                stack.emplace_back(w, out_begin(w));
+            }
+        }
+    }
+    if (removed == 0) return 0;
+
+    std::vector<WeightedEdge> kept;
+    kept.reserve(num_edges() - removed);
+    for (std::uint32_t u = 0; u < n; ++u) {
+        for (std::size_t i = out_begin(u); i < out_end(u); ++i) {
+            if (!back[i]) kept.push_back({ u, out_adj_[i], out_width_[i] });
+        }
+    }
+    build(std::move(kept));
+    return removed;
+}
+
+std::vector<WeightedEdge> WeightedDAG::edges() const {
+    std::vector<WeightedEdge> out;
+    out.reserve(num_edges());
+    for (std::uint32_t u = 0; u < num_nodes(); ++u) {
+        for (std::size_t i = out_begin(u); i < out_end(u); ++i) out.push_back({ u, out_adj_[i], out_width_[i] });
+    }
+    return out;
+}
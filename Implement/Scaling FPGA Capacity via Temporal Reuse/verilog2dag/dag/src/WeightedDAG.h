@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 分区用的带权 DAG（implement.py 的 Graph）：节点带资源 cv，边带位宽 we。
+// 出边与入边各存一份 CSR，节点序号 0..n-1，同一对节点间至多一条边。
+
+struct WeightedEdge {
+    std::uint32_t u;
+    std::uint32_t v;
+    std::int64_t bitwidth;
+};
+
+class WeightedDAG {
+public:
+    WeightedDAG() = default;
+    WeightedDAG(std::vector<std::int64_t> resources, std::vector<WeightedEdge> edges, std::vector<std::string> names = {});
+
+    // 读 verilog2dag 写出的 .dag 文本（见 DAG::to_weighted）
+    static WeightedDAG read(const std::string& path);
+
+    std::size_t num_nodes() const { return resource_.size(); }
+    std::size_t num_edges() const { return out_adj_.size(); }
+    std::int64_t resource(std::size_t v) const { return resource_[v]; }
+    const std::string& name(std::size_t v) const { return names_[v]; }
+    bool has_names() const { return !names_.empty(); }
+
+    // 邻接区间 [begin, end)，下标同时索引 *_adj 与 *_width
+    std::size_t out_begin(std::size_t v) const { return out_off_[v]; }
+    std::size_t out_end(std::size_t v) const { return out_off_[v + 1]; }
+    std::size_t in_begin(std::size_t v) const { return in_off_[v]; }
+    std::size_t in_end(std::size_t v) const { return in_off_[v + 1]; }
+    std::uint32_t out_node(std::size_t i) const { return out_adj_[i]; }
+    std::int64_t out_width(std::size_t i) const { return out_width_[i]; }
+    std::uint32_t in_node(std::size_t i) const { return in_adj_[i]; }
+    std::int64_t in_width(std::size_t i) const { return in_width_[i]; }
+
+    // Kahn 拓扑序，同时入度为 0 的节点按序号先后；有环时返回空
+    std::vector<std::uint32_t> topological_order() const;
+    // 删去迭代 DFS 找到的回边使图无环（ExampleGenerator._remove_cycles 的做法），返回删去的边数
+    std::size_t remove_back_edges();
+
+    std::vector<WeightedEdge> edges() const;
+
+private:
+    void build(std::vector<WeightedEdge> edges);
+
+    std::vector<std::int64_t> resource_;
+    std::vector<std::string> names_;
+    std::vector<std::size_t> out_off_{0};
+    std::vector<std::uint32_t> out_adj_;
+    std::vector<std::int64_t> out_width_;
+    std::vector<std::size_t> in_off_{0};
+    std::vector<std::uint32_t> in_adj_;
+    std::vector<std::int64_t> in_width_;
+};
@@ -1,33 +1,42 @@
 #pragma once
 #include "Json.h"
+#include "global/symbol_table.hh"
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 // Yosys JSON 模型：模块、端口、单元与连接
 
+// 名字（模块、单元、端口、类型、方向）都是 YDesign::symbols 里的符号，比较与哈希都是整数操作
+using global::Symbol;
+
 struct YPort {
-    std::string name;
-    std::string direction; // "input" / "output" / "inout"
+    Symbol name = global::NO_SYMBOL;
+    Symbol direction = global::NO_SYMBOL; // "input" / "output" / "inout"
     std::vector<int> bits; // 位 ID
 };
 
 struct YCell {
-    std::string name;
-    std::string type;
-    std::unordered_map<std::string, std::vector<int>> connections; // 端口到位ID列表
-    std::unordered_map<std::string, std::string> port_directions;  // 端口方向
+    Symbol name = global::NO_SYMBOL;
+    Symbol type = global::NO_SYMBOL;
+    std::unordered_map<Symbol, std::vector<int>> connections; // 端口到位ID列表
+    std::unordered_map<Symbol, Symbol> port_directions;      // 端口方向
 };
 
 struct YModule {
-    std::string name;
-    std::unordered_map<std::string, YPort> ports;
-    std::unordered_map<std::string, YCell> cells;
+    Symbol name = global::NO_SYMBOL;
+    std::unordered_map<Symbol, YPort> ports;
+    std::unordered_map<Symbol, YCell> cells;
 };
 
 struct YDesign {
-    std::unordered_map<std::string, YModule> modules;
-    std::string top;
+    global::SymbolTable symbols;
+    Symbol input = symbols.intern("input");
+    Symbol output = symbols.intern("output");
+    std::unordered_map<Symbol, YModule> modules;
+    Symbol top = global::NO_SYMBOL;
+
+    std::string name(Symbol s) const { return s == global::NO_SYMBOL ? std::string() : symbols.string(s); }
 };
 
 // 从 JSON DOM 构建 YDesign
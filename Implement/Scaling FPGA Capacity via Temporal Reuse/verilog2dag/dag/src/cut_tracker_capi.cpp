@@ -0,0 +1,48 @@
+#include "cut_tracker_capi.h"
+#include "CutTracker.h"
+#include <exception>
+#include <memory>
+#include <vector>
+
+// 图与分区数组归句柄所有，CutTracker 引用它们
+struct ct_tracker {
+    WeightedDAG graph;
+    std::vector<std::uint32_t> part;
+    std::unique_ptr<CutTracker> cut;
+};
+
+ct_tracker* ct_create(size_t num_nodes, size_t num_edges, const uint32_t* src, const uint32_t* dst,
+                      const int64_t* width, const uint32_t* part) {
+    try {
+        std::vector<WeightedEdge> edges(num_edges);
+        for (std::size_t i = 0; i < num_edges; ++i) edges[i] = {src[i], dst[i], width[i]};
+        auto t = std::make_unique<ct_tracker>();
+        t->graph = WeightedDAG(std::vector<std::int64_t>(num_nodes, 0), std::move(edges));
+        t->part.assign(part, part + num_nodes);
+        t->cut = std::make_unique<CutTracker>(t->graph, t->part);
+        return t.release();
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+}
+
+void ct_destroy(ct_tracker* t) {
+    delete t;
+}
+
+int64_t ct_cutsize(const ct_tracker* t) {
+    return t->cut->cutsize();
+}
+
+int64_t ct_reduction(const ct_tracker* t, uint32_t v, uint32_t to) {
+    return t->cut->reduction(v, to);
+}
+
+void ct_move(ct_tracker* t, uint32_t v, uint32_t to) {
+    t->cut->move(v, to);
+    t->part[v] = to;
+}
+
+void ct_relabel(ct_tracker* t, const uint32_t* part) {
+    t->part.assign(part, part + t->part.size());
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// CutTracker 的 C 接口，供 implement.py 经 ctypes 调用（见 cut_tracker.py）。
+// 节点用 0..n-1 的序号，边 i 为 src[i] -> dst[i]、位宽 width[i]；part 每个节点一个分区号。
+// 重复边位宽相加、自环忽略，与 WeightedDAG 相同。出错时 ct_create 返回 NULL。
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ct_tracker ct_tracker;
+
+ct_tracker* ct_create(size_t num_nodes, size_t num_edges, const uint32_t* src, const uint32_t* dst,
+                      const int64_t* width, const uint32_t* part);
+void ct_destroy(ct_tracker* t);
+
+int64_t ct_cutsize(const ct_tracker* t);
+int64_t ct_reduction(const ct_tracker* t, uint32_t v, uint32_t to);     // v 移到 to 后割减少多少
+void ct_move(ct_tracker* t, uint32_t v, uint32_t to);
+void ct_relabel(ct_tracker* t, const uint32_t* part);   // 分区号整体重映射（一一对应）之后，割不变
+
+#ifdef __cplusplus
+}
+#endif
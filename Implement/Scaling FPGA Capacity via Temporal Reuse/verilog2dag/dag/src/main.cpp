@@ -1,26 +1,20 @@
 #include "Json.h"
 #include "YosysModel.h"
 #include "DAGBuilder.h"
+#include "global/mapped_file.hh"
 #include <fstream>
 #include <iostream>
-#include <sstream>
 
 // 入口：读取 Yosys JSON，构建模块数据流 DAG，输出 Graphviz DOT
 
-static std::string read_file(const std::string& path) {
-    std::ifstream ifs(path, std::ios::binary);
-    if (!ifs) throw std::runtime_error("Cannot open file: " + path);
-    std::ostringstream oss; oss << ifs.rdbuf();
-    return oss.str();
-}
-
 int main(int argc, char** argv) {
     try {
         std::string in = argc > 1 ? argv[1] : "../hierarchy_voter.json";
         std::string out = argc > 2 ? argv[2] : "dag_voter.dot";
 
-        std::string text = read_file(in);
-        json::Parser parser(text);
+        // 输入文件直接 mmap，解析器在映射页上读取，不再整体拷贝到堆上
+        global::MappedFile text(in);
+        json::Parser parser(text.view());
         json::Value root = parser.parse();
 
         YosysJsonReader reader(root);
@@ -29,13 +23,15 @@ int main(int argc, char** argv) {
         DAGBuilder builder(design);
         DAG g = builder.build_for_top(true);
 
+        // 输出文件以 .dag 结尾时写带权 DAG（dag_partition 的输入），否则写 DOT
+        const bool weighted = out.size() >= 4 && out.compare(out.size() - 4, 4, ".dag") == 0;
         std::ofstream ofs(out);
-        ofs << g.to_dot();
+        ofs << (weighted ? g.to_weighted() : g.to_dot());
         ofs.close();
 
-        std::cout << "Top module: " << design.top << "\n";
+        std::cout << "Top module: " << design.name(design.top) << "\n";
         std::cout << "Nodes: " << g.nodes().size() << ", Edges: " << g.edges().size() << "\n";
-        std::cout << "DOT written to: " << out << "\n";
+        std::cout << (weighted ? "Weighted DAG" : "DOT") << " written to: " << out << "\n";
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
@@ -0,0 +1,65 @@
+#include "AcyclicPartitioner.h"
+#include "WeightedDAG.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// 入口：读取 verilog2dag 写出的带权 DAG（.dag），做无环分区（implement.py Algorithm 1），
+// 每个节点一行写出分区号
+
+int main(int argc, char** argv) {
+    try {
+        if (argc < 4) {
+            std::cerr << "Usage: " << argv[0] << " <graph.dag> <resource_limit> <size_limit> [output] [--break-cycles]\n";
+            std::cerr << "Example: " << argv[0] << " voter.dag 150 4 voter.parts\n";
+            return 1;
+        }
+        std::string in = argv[1];
+        PartitionOptions options;
+        options.resource_limit = std::stoll(argv[2]);
+        options.size_limit = std::stoul(argv[3]);
+        std::string out = in + ".parts";
+        bool break_cycles = false;
+        // 其余参数：输出路径；--break-cycles 先删去 DFS 回边（时序电路经过寄存器的环），否则输入必须无环
+        for (int i = 4; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--break-cycles") break_cycles = true;
+            else out = arg;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        WeightedDAG g = WeightedDAG::read(in);
+        std::cout << "Nodes: " << g.num_nodes() << ", Edges: " << g.num_edges() << "\n";
+        if (break_cycles) {
+            const auto removed = g.remove_back_edges();
+            if (removed > 0) std::cout << "Removed " << removed << " back edges\n";
+        }
+
+        AcyclicPartitioner partitioner(g, options);
+        const auto part = partitioner.run();
+        const auto& history = partitioner.cutsize_history();
+        std::cout << "Initial cutsize: " << history.front() << "\n";
+        for (std::size_t i = 1; i < history.size(); ++i) {
+            std::cout << "Pass " << i << ": cutsize = " << history[i] << " (-" << history[i - 1] - history[i] << ")\n";
+        }
+
+        std::int64_t heaviest = 0;
+        for (std::size_t p = 0; p < partitioner.num_parts(); ++p) heaviest = std::max(heaviest, partitioner.part_resource(p));
+        std::cout << "Partitions: " << partitioner.num_parts() << ", cutsize: " << history.back()
+                  << ", max resource: " << heaviest << "/" << options.resource_limit << "\n";
+
+        std::ofstream ofs(out);
+        for (auto p : part) ofs << p << "\n";
+        ofs.close();
+        if (!ofs) throw std::runtime_error("cannot write " + out);
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Partition written to: " << out << " (" << elapsed.count() << " s)\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}